@@ -48,7 +48,7 @@ const struct cmd_entry cmd_capture_pane_entry = {
 
 	.target = { 't', CMD_FIND_PANE, 0 },
 
-	.flags = CMD_AFTERHOOK,
+	.flags = CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_capture_pane_exec
 };
 
@@ -258,7 +258,8 @@ cmd_capture_pane_history(struct args *args, struct cmdq_item *item,
 	struct screen			*s;
 	struct grid_cell		*gc = NULL;
 	struct window_mode_entry	*wme;
-	int				 n, join_lines, number_lines, flags = 0;
+	int				 n, start, end, join_lines, number_lines;
+	int				 flags = 0;
 	int				 show_flags, hyperlinks;
 	u_int				*links = NULL, nlinks = 0;
 	u_int				 i, sx, top, bottom, tmp;
@@ -293,38 +294,52 @@ cmd_capture_pane_history(struct args *args, struct cmdq_item *item,
 
 	Sflag = args_get(args, 'S');
 	if (Sflag != NULL && strcmp(Sflag, "-") == 0)
-		top = 0;
+		start = INT_MIN;
 	else {
-		n = args_strtonum_and_expand(args, 'S', INT_MIN, SHRT_MAX,
+		start = args_strtonum_and_expand(args, 'S', INT_MIN, SHRT_MAX,
 			item, &cause);
 		if (cause != NULL) {
-			top = gd->hsize;
+			start = 0;
 			free(cause);
-		} else if (n < 0 && (u_int)-n > gd->hsize)
-			top = 0;
-		else
-			top = gd->hsize + n;
-		if (top > gd->hsize + gd->sy - 1)
-			top = gd->hsize + gd->sy - 1;
+		}
 	}
 
 	Eflag = args_get(args, 'E');
 	if (Eflag != NULL && strcmp(Eflag, "-") == 0)
-		bottom = gd->hsize + gd->sy - 1;
+		end = INT_MAX;
 	else {
-		n = args_strtonum_and_expand(args, 'E', INT_MIN, SHRT_MAX,
+		end = args_strtonum_and_expand(args, 'E', INT_MIN, SHRT_MAX,
 			item, &cause);
 		if (cause != NULL) {
-			bottom = gd->hsize + gd->sy - 1;
+			end = INT_MAX;
 			free(cause);
-		} else if (n < 0 && (u_int)-n > gd->hsize)
-			bottom = 0;
-		else
-			bottom = gd->hsize + n;
-		if (bottom > gd->hsize + gd->sy - 1)
-			bottom = gd->hsize + gd->sy - 1;
+		}
 	}
 
+	/*
+	 * Any history to be captured which has not been reflowed must be
+	 * reflowed first.
+	 */
+	n = (start < end) ? start : end;
+	if (n < 0 && (n == INT_MIN || (u_int)-n > gd->hsize - gd->reflow_lines))
+		grid_reflow_history(gd, 0);
+
+	if (start < 0 && (start == INT_MIN || (u_int)-start > gd->hsize))
+		top = 0;
+	else
+		top = gd->hsize + start;
+	if (top > gd->hsize + gd->sy - 1)
+		top = gd->hsize + gd->sy - 1;
+
+	if (end == INT_MAX)
+		bottom = gd->hsize + gd->sy - 1;
+	else if (end < 0 && (end == INT_MIN || (u_int)-end > gd->hsize))
+		bottom = 0;
+	else
+		bottom = gd->hsize + end;
+	if (bottom > gd->hsize + gd->sy - 1)
+		bottom = gd->hsize + gd->sy - 1;
+
 	if (bottom < top) {
 		tmp = bottom;
 		bottom = top;
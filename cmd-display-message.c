@@ -45,7 +45,7 @@ const struct cmd_entry cmd_display_message_entry = {
 
 	.target = { 't', CMD_FIND_PANE, CMD_FIND_CANFAIL },
 
-	.flags = CMD_AFTERHOOK|CMD_CLIENT_CFLAG|CMD_CLIENT_CANFAIL,
+	.flags = CMD_AFTERHOOK|CMD_CLIENT_CFLAG|CMD_CLIENT_CANFAIL|CMD_QUERY,
 	.exec = cmd_display_message_exec
 };
 
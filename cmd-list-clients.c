@@ -46,7 +46,7 @@ const struct cmd_entry cmd_list_clients_entry = {
 
 	.target = { 't', CMD_FIND_SESSION, 0 },
 
-	.flags = CMD_READONLY|CMD_AFTERHOOK,
+	.flags = CMD_READONLY|CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_list_clients_exec
 };
 
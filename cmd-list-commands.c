@@ -41,7 +41,7 @@ const struct cmd_entry cmd_list_commands_entry = {
 	.args = { "F:", 0, 1, NULL },
 	.usage = "[-F format] [command]",
 
-	.flags = CMD_STARTSERVER|CMD_AFTERHOOK,
+	.flags = CMD_STARTSERVER|CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_list_commands
 };
 
@@ -48,7 +48,7 @@ const struct cmd_entry cmd_list_keys_entry = {
 	.usage = "[-1aNr] [-F format] [-O order] [-P prefix-string]"
 		 "[-T key-table] [key]",
 
-	.flags = CMD_STARTSERVER|CMD_AFTERHOOK,
+	.flags = CMD_STARTSERVER|CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_list_keys_exec
 };
 
@@ -44,7 +44,7 @@ const struct cmd_entry cmd_list_panes_entry = {
 
 	.target = { 't', CMD_FIND_WINDOW, 0 },
 
-	.flags = CMD_AFTERHOOK,
+	.flags = CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_list_panes_exec
 };
 
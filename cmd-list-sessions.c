@@ -45,7 +45,7 @@ const struct cmd_entry cmd_list_sessions_entry = {
 	.args = { "F:f:O:r", 0, 0, NULL },
 	.usage = "[-r] [-F format] [-f filter] [-O order]",
 
-	.flags = CMD_AFTERHOOK,
+	.flags = CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_list_sessions_exec
 };
 
@@ -51,7 +51,7 @@ const struct cmd_entry cmd_list_windows_entry = {
 
 	.target = { 't', CMD_FIND_SESSION, 0 },
 
-	.flags = CMD_AFTERHOOK,
+	.flags = CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_list_windows_exec
 };
 
@@ -60,7 +60,7 @@ const struct cmd_entry cmd_has_session_entry = {
 
 	.target = { 't', CMD_FIND_SESSION, 0 },
 
-	.flags = 0,
+	.flags = CMD_QUERY,
 	.exec = cmd_new_session_exec
 };
 
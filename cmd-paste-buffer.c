@@ -33,8 +33,8 @@ const struct cmd_entry cmd_paste_buffer_entry = {
 	.name = "paste-buffer",
 	.alias = "pasteb",
 
-	.args = { "db:prSs:t:", 0, 0, NULL },
-	.usage = "[-dprS] [-s separator] " CMD_BUFFER_USAGE " "
+	.args = { "cdb:prSs:t:", 0, 0, NULL },
+	.usage = "[-cdprS] [-s separator] " CMD_BUFFER_USAGE " "
 		 CMD_TARGET_PANE_USAGE,
 
 	.target = { 't', CMD_FIND_PANE, 0 },
@@ -43,17 +43,6 @@ const struct cmd_entry cmd_paste_buffer_entry = {
 	.exec = cmd_paste_buffer_exec
 };
 
-static void
-cmd_paste_buffer_paste(struct window_pane *wp, const char *buf, size_t len)
-{
-	char	*cp;
-	size_t	 n;
-
-	n = utf8_stravisx(&cp, buf, len, VIS_SAFE|VIS_NOSLASH);
-	bufferevent_write(wp->event, cp, n);
-	free(cp);
-}
-
 static enum cmd_retval
 cmd_paste_buffer_exec(struct cmd *self, struct cmdq_item *item)
 {
@@ -61,9 +50,13 @@ cmd_paste_buffer_exec(struct cmd *self, struct cmdq_item *item)
 	struct cmd_find_state	*target = cmdq_get_target(item);
 	struct window_pane	*wp = target->wp;
 	struct paste_buffer	*pb;
-	const char		*sepstr, *bufname, *bufdata, *bufend, *line;
-	size_t			 seplen, bufsize, len;
-	int			 bracket = args_has(args, 'p');
+	const char		*sepstr, *bufname;
+	int			 flags = 0;
+
+	if (args_has(args, 'c')) {
+		paste_cancel(wp);
+		return (CMD_RETURN_NORMAL);
+	}
 
 	if (window_pane_exited(wp)) {
 		cmdq_error(item, "target pane has exited");
@@ -92,37 +85,11 @@ cmd_paste_buffer_exec(struct cmd *self, struct cmdq_item *item)
 			else
 				sepstr = "\r";
 		}
-		seplen = strlen(sepstr);
-
-		if (bracket && (wp->screen->mode & MODE_BRACKETPASTE))
-			bufferevent_write(wp->event, "\033[200~", 6);
-
-		bufdata = paste_buffer_data(pb, &bufsize);
-		bufend = bufdata + bufsize;
-
-		for (;;) {
-			line = memchr(bufdata, '\n', bufend - bufdata);
-			if (line == NULL)
-				break;
-			len = line - bufdata;
-			if (args_has(args, 'S'))
-				bufferevent_write(wp->event, bufdata, len);
-			else
-				cmd_paste_buffer_paste(wp, bufdata, len);
-			bufferevent_write(wp->event, sepstr, seplen);
-
-			bufdata = line + 1;
-		}
-		if (bufdata != bufend) {
-			len = bufend - bufdata;
-			if (args_has(args, 'S'))
-				bufferevent_write(wp->event, bufdata, len);
-			else
-				cmd_paste_buffer_paste(wp, bufdata, len);
-		}
-
-		if (bracket && (wp->screen->mode & MODE_BRACKETPASTE))
-			bufferevent_write(wp->event, "\033[201~", 6);
+		if (args_has(args, 'S'))
+			flags |= PASTE_RAW;
+		if (args_has(args, 'p'))
+			flags |= PASTE_BRACKET;
+		paste_send(wp, pb, sepstr, flags);
 	}
 
 	if (pb != NULL && args_has(args, 'd'))
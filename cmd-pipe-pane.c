@@ -204,6 +204,7 @@ cmd_pipe_pane_read_callback(__unused struct bufferevent *bufev, void *data)
 	available = EVBUFFER_LENGTH(evb);
 	log_debug("%%%u pipe read %zu", wp->id, available);
 
+	paste_flush(wp);
 	bufferevent_write(wp->event, EVBUFFER_DATA(evb), available);
 	evbuffer_drain(evb, available);
 
@@ -51,6 +51,7 @@ struct cmdq_item {
 
 	u_int			 number;
 	time_t			 time;
+	char			*request;
 
 	int			 flags;
 
@@ -343,6 +344,8 @@ cmdq_insert_after(struct cmdq_item *after, struct cmdq_item *item)
 		if (c != NULL)
 			c->references++;
 		item->client = c;
+		if (item->request == NULL && after->request != NULL)
+			item->request = xstrdup(after->request);
 
 		item->queue = queue;
 		TAILQ_INSERT_AFTER(&queue->list, after, item, entry);
@@ -355,33 +358,32 @@ cmdq_insert_after(struct cmdq_item *after, struct cmdq_item *item)
 	return (after);
 }
 
-/* Insert a hook. */
+/*
+ * Set the request ID for an item and any following it, so it is shown on the
+ * guard lines for a control client.
+ */
 void
-cmdq_insert_hook(__unused struct session *s, struct cmdq_item *item,
-    struct cmd_find_state *current, const char *fmt, ...)
+cmdq_set_request(struct cmdq_item *item, const char *request)
+{
+	while (item != NULL) {
+		free(item->request);
+		item->request = xstrdup(request);
+		item = item->next;
+	}
+}
+
+/* Add the arguments of a command to a hook payload when first needed. */
+static void
+cmdq_fill_hook(struct event_payload *ep, void *data)
 {
-	struct cmd			*cmd = item->cmd;
-	struct args			*args = cmd_get_args(cmd);
+	struct cmdq_item		*item = data;
+	struct args			*args = cmd_get_args(item->cmd);
 	struct args_entry		*ae;
 	struct args_value		*av;
-	struct event_payload		*ep;
-	va_list				 ap;
-	char				*name, tmp[32], flag, *arguments;
+	char				 tmp[32], flag, *arguments;
 	u_int				 i;
 	const char			*value;
 
-	if (item->state->flags & CMDQ_STATE_NOHOOKS)
-		return;
-
-	va_start(ap, fmt);
-	xvasprintf(&name, fmt, ap);
-	va_end(ap);
-
-	ep = event_payload_create();
-	if (current != NULL)
-		event_payload_set_target(ep, current);
-	event_payload_set_pointer(ep, "_cmdq_item", item, NULL, NULL);
-
 	arguments = args_print(args);
 	event_payload_set_string(ep, "arguments", "%s", arguments);
 	free(arguments);
@@ -410,6 +412,35 @@ cmdq_insert_hook(__unused struct session *s, struct cmdq_item *item,
 
 		flag = args_next(&ae);
 	}
+}
+
+/* Insert a hook. */
+void
+cmdq_insert_hook(__unused struct session *s, struct cmdq_item *item,
+    struct cmd_find_state *current, const char *fmt, ...)
+{
+	struct event_payload		*ep;
+	va_list				 ap;
+	char				*name;
+
+	if (item->state->flags & CMDQ_STATE_NOHOOKS)
+		return;
+
+	va_start(ap, fmt);
+	xvasprintf(&name, fmt, ap);
+	va_end(ap);
+
+	/* Nothing to do if nobody is listening. */
+	if (!events_has_sinks(name) && log_get_level() == 0) {
+		free(name);
+		return;
+	}
+
+	ep = event_payload_create();
+	if (current != NULL)
+		event_payload_set_target(ep, current);
+	event_payload_set_pointer(ep, "_cmdq_item", item, NULL, NULL);
+	event_payload_set_fill(ep, cmdq_fill_hook, item);
 
 	events_fire(name, ep);
 	free(name);
@@ -434,6 +465,7 @@ cmdq_remove(struct cmdq_item *item)
 
 	TAILQ_REMOVE(&item->queue->list, item, entry);
 
+	free(item->request);
 	free(item->name);
 	free(item);
 }
@@ -698,13 +730,41 @@ cmdq_fire_callback(struct cmdq_item *item)
 	return (item->cb(item, item->data));
 }
 
+/*
+ * Can this item be skipped while an earlier one waits? For a control client
+ * using request IDs, only items for the same request must stay in order, so
+ * other requests can go ahead of a waiting request. Any item without a
+ * request ID is a barrier.
+ */
+static int
+cmdq_can_skip(struct client *c, struct cmdq_item *item)
+{
+	if (c == NULL || (~c->flags & CLIENT_CONTROL_REQUESTS))
+		return (0);
+	return (item->request != NULL);
+}
+
+/*
+ * Can this item run ahead of a waiting request? Only commands which report
+ * state without changing it may do so, anything else is a barrier.
+ */
+static int
+cmdq_can_overtake(struct client *c, struct cmdq_item *item)
+{
+	if (!cmdq_can_skip(c, item) || item->type != CMDQ_COMMAND)
+		return (0);
+	return (cmd_get_entry(item->cmd)->flags & CMD_QUERY);
+}
+
 /* Process next item on command queue. */
 u_int
 cmdq_next(struct client *c)
 {
 	struct cmdq_list	*queue = cmdq_get(c);
 	const char		*name = cmdq_name(c);
-	struct cmdq_item	*item;
+	struct cmdq_item	*item, *next;
+	const char		**skip = NULL;
+	u_int			 nskip = 0, i;
 	enum cmd_retval		 retval;
 	u_int			 items = 0;
 	static u_int		 number;
@@ -713,16 +773,35 @@ cmdq_next(struct client *c)
 		log_debug("%s %s: empty", __func__, name);
 		return (0);
 	}
-	if (TAILQ_FIRST(&queue->list)->flags & CMDQ_WAITING) {
+	item = TAILQ_FIRST(&queue->list);
+	if ((item->flags & CMDQ_WAITING) && !cmdq_can_skip(c, item)) {
 		log_debug("%s %s: waiting", __func__, name);
 		return (0);
 	}
 
 	log_debug("%s %s: enter", __func__, name);
-	for (;;) {
-		item = queue->item = TAILQ_FIRST(&queue->list);
-		if (item == NULL)
-			break;
+	while (item != NULL) {
+		/*
+		 * Skip the rest of any request that is waiting, or stop if it
+		 * is not possible to go ahead of them.
+		 */
+		if (nskip != 0) {
+			for (i = 0; i < nskip; i++) {
+				if (item->request != NULL &&
+				    strcmp(item->request, skip[i]) == 0)
+					break;
+			}
+			if (i != nskip) {
+				item = TAILQ_NEXT(item, entry);
+				continue;
+			}
+			if (!cmdq_can_overtake(c, item)) {
+				queue->item = NULL;
+				goto waiting;
+			}
+		}
+
+		queue->item = item;
 		log_debug("%s %s: %s (%d), flags %x", __func__, name,
 		    item->name, item->type, item->flags);
 
@@ -732,7 +811,7 @@ cmdq_next(struct client *c)
 		 * run-shell).
 		 */
 		if (item->flags & CMDQ_WAITING)
-			goto waiting;
+			goto skip;
 
 		/*
 		 * Items are only fired once, once the fired flag is set, a
@@ -764,22 +843,44 @@ cmdq_next(struct client *c)
 
 			if (retval == CMD_RETURN_WAIT) {
 				item->flags |= CMDQ_WAITING;
-				goto waiting;
+				goto skip;
 			}
 			items++;
 		}
+		next = TAILQ_NEXT(item, entry);
 		cmdq_remove(item);
+		item = next;
+		continue;
+
+	skip:
+		if (!cmdq_can_skip(c, item))
+			goto waiting;
+		log_debug("%s %s: skipping request %s", __func__, name,
+		    item->request);
+		skip = xreallocarray(skip, nskip + 1, sizeof *skip);
+		skip[nskip++] = item->request;
+		item = TAILQ_NEXT(item, entry);
 	}
 	queue->item = NULL;
 
-	log_debug("%s %s: exit (empty)", __func__, name);
+	log_debug("%s %s: exit (%s)", __func__, name,
+	    nskip == 0 ? "empty" : "skipped");
+	free(skip);
 	return (items);
 
 waiting:
 	log_debug("%s %s: exit (wait)", __func__, name);
+	free(skip);
 	return (items);
 }
 
+/* Is the queue empty? */
+int
+cmdq_empty(struct client *c)
+{
+	return (TAILQ_EMPTY(&cmdq_get(c)->list));
+}
+
 /* Get running item if any. */
 struct cmdq_item *
 cmdq_running(struct client *c)
@@ -802,7 +903,7 @@ cmdq_guard(struct cmdq_item *item, const char *guard, int flags)
 	u_int		 number = item->number;
 
 	if (c != NULL && (c->flags & CLIENT_CONTROL))
-		control_write_guard(c, guard, t, number, flags);
+		control_write_guard(c, guard, t, number, flags, item->request);
 }
 
 /* Show message from command. */
@@ -72,6 +72,8 @@ cmd_resize_pane_exec(struct cmd *self, struct cmdq_item *item)
 		if (!TAILQ_EMPTY(&wp->modes))
 			return (CMD_RETURN_NORMAL);
 		adjust = screen_size_y(&wp->base) - 1 - wp->base.cy;
+		if (adjust > (int)(gd->hsize - gd->reflow_lines))
+			grid_reflow_history(gd, 0);
 		if (adjust > (int)gd->hsize)
 			adjust = gd->hsize;
 		grid_remove_history(gd, adjust);
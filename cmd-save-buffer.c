@@ -51,7 +51,7 @@ const struct cmd_entry cmd_show_buffer_entry = {
 	.args = { "b:", 0, 0, NULL },
 	.usage = CMD_BUFFER_USAGE,
 
-	.flags = CMD_AFTERHOOK,
+	.flags = CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_save_buffer_exec
 };
 
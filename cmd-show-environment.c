@@ -43,7 +43,7 @@ const struct cmd_entry cmd_show_environment_entry = {
 
 	.target = { 't', CMD_FIND_SESSION, CMD_FIND_CANFAIL },
 
-	.flags = CMD_AFTERHOOK,
+	.flags = CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_show_environment_exec
 };
 
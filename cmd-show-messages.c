@@ -41,7 +41,7 @@ const struct cmd_entry cmd_show_messages_entry = {
 	.args = { "JTt:", 0, 0, NULL },
 	.usage = "[-JT] " CMD_TARGET_CLIENT_USAGE,
 
-	.flags = CMD_AFTERHOOK|CMD_CLIENT_TFLAG|CMD_CLIENT_CANFAIL,
+	.flags = CMD_AFTERHOOK|CMD_CLIENT_TFLAG|CMD_CLIENT_CANFAIL|CMD_QUERY,
 	.exec = cmd_show_messages_exec
 };
 
@@ -85,7 +85,8 @@ cmd_show_messages_exec(struct cmd *self, struct cmdq_item *item)
 		done = 1;
 	}
 	if (args_has(args, 'J')) {
-		job_print_summary(item, blank);
+		blank = job_print_summary(item, blank) || blank;
+		format_print_jobs(item, blank);
 		done = 1;
 	}
 	if (done)
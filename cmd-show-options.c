@@ -56,7 +56,7 @@ const struct cmd_entry cmd_show_options_entry = {
 
 	.target = { 't', CMD_FIND_PANE, CMD_FIND_CANFAIL },
 
-	.flags = CMD_AFTERHOOK,
+	.flags = CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_show_options_exec
 };
 
@@ -69,7 +69,7 @@ const struct cmd_entry cmd_show_window_options_entry = {
 
 	.target = { 't', CMD_FIND_WINDOW, CMD_FIND_CANFAIL },
 
-	.flags = CMD_AFTERHOOK,
+	.flags = CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_show_options_exec
 };
 
@@ -82,7 +82,7 @@ const struct cmd_entry cmd_show_hooks_entry = {
 
 	.target = { 't', CMD_FIND_PANE, CMD_FIND_CANFAIL },
 
-	.flags = CMD_AFTERHOOK,
+	.flags = CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_show_options_exec
 };
 
@@ -34,7 +34,7 @@ const struct cmd_entry cmd_show_prompt_history_entry = {
 	.args = { "T:", 0, 0, NULL },
 	.usage = "[-T prompt-type]",
 
-	.flags = CMD_AFTERHOOK,
+	.flags = CMD_AFTERHOOK|CMD_QUERY,
 	.exec = cmd_show_prompt_history_exec
 };
 
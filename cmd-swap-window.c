@@ -86,9 +86,11 @@ cmd_swap_window_exec(struct cmd *self, struct cmdq_item *item)
 	}
 	session_group_synchronize_from(src);
 	server_redraw_session_group(src);
+	events_fire_session("session-windows-changed", src);
 	if (src != dst) {
 		session_group_synchronize_from(dst);
 		server_redraw_session_group(dst);
+		events_fire_session("session-windows-changed", dst);
 	}
 	recalculate_sizes();
 
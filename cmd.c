@@ -659,9 +659,11 @@ cmd_list_copy(const struct cmd_list *cmdlist, int argc, char **argv)
 	u_int		 group = cmdlist->group;
 	char		*s;
 
-	s = cmd_list_print(cmdlist, 0);
-	log_debug("%s: %s", __func__, s);
-	free(s);
+	if (log_get_level() != 0) {
+		s = cmd_list_print(cmdlist, 0);
+		log_debug("%s: %s", __func__, s);
+		free(s);
+	}
 
 	new_cmdlist = cmd_list_new();
 	TAILQ_FOREACH(cmd, cmdlist->list, qentry) {
@@ -673,9 +675,11 @@ cmd_list_copy(const struct cmd_list *cmdlist, int argc, char **argv)
 		cmd_list_append(new_cmdlist, new_cmd);
 	}
 
-	s = cmd_list_print(new_cmdlist, 0);
-	log_debug("%s: %s", __func__, s);
-	free(s);
+	if (log_get_level() != 0) {
+		s = cmd_list_print(new_cmdlist, 0);
+		log_debug("%s: %s", __func__, s);
+		free(s);
+	}
 
 	return (new_cmdlist);
 }
@@ -287,6 +287,11 @@ void	warnx(const char *, ...);
 #define flock(fd, op) (0)
 #endif
 
+#ifndef HAVE_ARC4RANDOM_BUF
+/* arc4random_buf.c */
+void		 arc4random_buf(void *, size_t);
+#endif
+
 #ifndef HAVE_EXPLICIT_BZERO
 /* explicit_bzero.c */
 void		 explicit_bzero(void *, size_t);
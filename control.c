@@ -19,6 +19,7 @@
 
 #include <sys/types.h>
 
+#include <ctype.h>
 #include <errno.h>
 #include <event.h>
 #include <poll.h>
@@ -122,6 +123,34 @@ struct control_state {
 	TAILQ_HEAD(, control_line)	 deferred;
 };
 
+/*
+ * Parsed command lines. Control clients tend to send the same few commands
+ * over and over, so the most recently used lines are kept parsed, shared
+ * between all control clients. Lines that depend on anything other than
+ * their text when parsed (environment variables, ~ and %if) are not kept, and
+ * the cache is emptied when command-alias changes.
+ */
+struct control_parse {
+	char				*line;
+	struct cmd_list			*cmdlist;
+
+	RB_ENTRY(control_parse)		 entry;
+	TAILQ_ENTRY(control_parse)	 lru_entry;
+};
+RB_HEAD(control_parses, control_parse);
+static TAILQ_HEAD(control_parse_list, control_parse) control_parse_lru =
+    TAILQ_HEAD_INITIALIZER(control_parse_lru);
+static u_int	control_parse_count;
+static u_int	control_parse_hits;
+static u_int	control_parse_misses;
+
+/* Maximum length of a request ID. */
+#define CONTROL_REQUEST_MAXIMUM 32
+
+/* Maximum number and length of parsed command lines to keep. */
+#define CONTROL_PARSE_ENTRIES 64
+#define CONTROL_PARSE_MAXIMUM 1024
+
 /* Low and high watermarks. */
 #define CONTROL_BUFFER_LOW 512
 #define CONTROL_BUFFER_HIGH 8192
@@ -161,6 +190,15 @@ control_window_cmp(struct control_window *cw1, struct control_window *cw2)
 }
 RB_GENERATE_STATIC(control_windows, control_window, entry, control_window_cmp);
 
+/* Compare parsed command lines. */
+static int
+control_parse_cmp(struct control_parse *cp1, struct control_parse *cp2)
+{
+	return (strcmp(cp1->line, cp2->line));
+}
+RB_GENERATE_STATIC(control_parses, control_parse, entry, control_parse_cmp);
+static struct control_parses control_parses = RB_INITIALIZER(&control_parses);
+
 /* Free a block. */
 static void
 control_free_block(struct control_state *cs, struct control_block *cb)
@@ -474,7 +512,7 @@ control_write(struct client *c, const char *fmt, ...)
  */
 void
 control_write_guard(struct client *c, const char *guard, long t, u_int number,
-    int flags)
+    int flags, const char *request)
 {
 	struct control_state	*cs = c->control_state;
 	char			*line;
@@ -482,7 +520,11 @@ control_write_guard(struct client *c, const char *guard, long t, u_int number,
 	if (strcmp(guard, "begin") == 0)
 		cs->guard_depth++;
 
-	xasprintf(&line, "%%%s %ld %u %d", guard, t, number, flags);
+	if (request != NULL) {
+		xasprintf(&line, "%%%s %ld %u %d %s", guard, t, number, flags,
+		    request);
+	} else
+		xasprintf(&line, "%%%s %ld %u %d", guard, t, number, flags);
 	control_write_line(c, line);
 
 	if (strcmp(guard, "begin") != 0 && cs->guard_depth > 0 &&
@@ -633,6 +675,150 @@ control_error_callback(__unused struct bufferevent *bufev,
 	c->flags |= CLIENT_EXIT;
 }
 
+/* Free a parsed command line. */
+static void
+control_free_parse(struct control_parse *cp)
+{
+	RB_REMOVE(control_parses, &control_parses, cp);
+	TAILQ_REMOVE(&control_parse_lru, cp, lru_entry);
+	control_parse_count--;
+
+	cmd_list_free(cp->cmdlist);
+	free(cp->line);
+	free(cp);
+}
+
+/* Forget all parsed command lines. */
+void
+control_flush_parse_cache(void)
+{
+	struct control_parse	*cp, *cp1;
+
+	RB_FOREACH_SAFE(cp, control_parses, &control_parses, cp1)
+		control_free_parse(cp);
+}
+
+/* Get parsed command line statistics. */
+void
+control_parse_stats(u_int *hits, u_int *misses)
+{
+	*hits = control_parse_hits;
+	*misses = control_parse_misses;
+}
+
+/* Can this line be kept parsed? */
+static int
+control_can_cache_parse(const char *line)
+{
+	const char	*cp;
+
+	if (strlen(line) > CONTROL_PARSE_MAXIMUM)
+		return (0);
+	if (strpbrk(line, "$~") != NULL)
+		return (0);
+	for (cp = line; (cp = strchr(cp, '%')) != NULL; cp++) {
+		if (isalpha((u_char)cp[1]))
+			return (0);
+	}
+	return (1);
+}
+
+/* Append a command list to the queue with a request ID. */
+static void
+control_append(struct client *c, struct cmd_list *cmdlist,
+    struct cmdq_state *state, const char *request)
+{
+	struct cmdq_item	*item;
+
+	item = cmdq_get_command(cmdlist, state);
+	if (item == NULL)
+		return;
+	if (request != NULL)
+		cmdq_set_request(item, request);
+	cmdq_append(c, item);
+}
+
+/* Parse a command line and append it to the queue, using a kept copy. */
+static enum cmd_parse_status
+control_parse_and_append(struct client *c, const char *line,
+    struct cmdq_state *state, const char *request, char **error)
+{
+	struct control_parse	*cp, find = { .line = (char *)line };
+	struct cmd_parse_result	*pr;
+	struct cmd_list		*cmdlist;
+	int			 cache;
+
+	cache = control_can_cache_parse(line);
+	if (cache) {
+		cp = RB_FIND(control_parses, &control_parses, &find);
+		if (cp != NULL) {
+			control_parse_hits++;
+			TAILQ_REMOVE(&control_parse_lru, cp, lru_entry);
+			TAILQ_INSERT_HEAD(&control_parse_lru, cp, lru_entry);
+
+			/*
+			 * If the list is still in use by a queued item, use a
+			 * copy so the commands get their own group.
+			 */
+			if (cp->cmdlist->references == 1) {
+				control_append(c, cp->cmdlist, state, request);
+				return (CMD_PARSE_SUCCESS);
+			}
+			cmdlist = cmd_list_copy(cp->cmdlist, 0, NULL);
+			control_append(c, cmdlist, state, request);
+			cmd_list_free(cmdlist);
+			return (CMD_PARSE_SUCCESS);
+		}
+		control_parse_misses++;
+	}
+
+	pr = cmd_parse_from_string(line, NULL);
+	if (pr->status == CMD_PARSE_ERROR) {
+		*error = pr->error;
+		return (CMD_PARSE_ERROR);
+	}
+	control_append(c, pr->cmdlist, state, request);
+	if (!cache) {
+		cmd_list_free(pr->cmdlist);
+		return (CMD_PARSE_SUCCESS);
+	}
+
+	if (control_parse_count == CONTROL_PARSE_ENTRIES) {
+		cp = TAILQ_LAST(&control_parse_lru, control_parse_list);
+		control_free_parse(cp);
+	}
+	cp = xcalloc(1, sizeof *cp);
+	cp->line = xstrdup(line);
+	cp->cmdlist = pr->cmdlist;
+	RB_INSERT(control_parses, &control_parses, cp);
+	TAILQ_INSERT_HEAD(&control_parse_lru, cp, lru_entry);
+	control_parse_count++;
+
+	return (CMD_PARSE_SUCCESS);
+}
+
+/*
+ * Split the request ID from the start of a line. IDs are chosen by the client
+ * and may be up to CONTROL_REQUEST_MAXIMUM letters, digits, -, _ or '.'.
+ */
+static char *
+control_split_request(char *line, char **request)
+{
+	size_t	n;
+
+	n = strspn(line, "abcdefghijklmnopqrstuvwxyz"
+	    "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_.");
+	if (n == 0 || n > CONTROL_REQUEST_MAXIMUM)
+		return (NULL);
+	if (line[n] != '\0' && line[n] != ' ' && line[n] != '\t')
+		return (NULL);
+	*request = line;
+	if (line[n] == '\0')
+		return (line + n);
+	line[n] = '\0';
+	return (line + n + 1);
+}
+
 /* Control client input callback. Read lines and fire commands. */
 static void
 control_read_callback(__unused struct bufferevent *bufev, void *data)
@@ -640,8 +826,9 @@ control_read_callback(__unused struct bufferevent *bufev, void *data)
 	struct client		*c = data;
 	struct control_state	*cs = c->control_state;
 	struct evbuffer		*buffer = cs->read_event->input;
-	char			*line, *error;
+	char			*line, *cmd, *request, *error;
 	struct cmdq_state	*state;
+	struct cmdq_item	*item;
 	enum cmd_parse_status	 status;
 
 	for (;;) {
@@ -655,10 +842,28 @@ control_read_callback(__unused struct bufferevent *bufev, void *data)
 			break;
 		}
 
+		cmd = line;
+		request = NULL;
+		if (c->flags & CLIENT_CONTROL_REQUESTS) {
+			cmd = control_split_request(line, &request);
+			if (cmd == NULL) {
+				item = cmdq_get_callback(control_error,
+				    xstrdup("invalid request ID"));
+				cmdq_append(c, item);
+				free(line);
+				continue;
+			}
+		}
+
 		state = cmdq_new_state(NULL, NULL, CMDQ_STATE_CONTROL);
-		status = cmd_parse_and_append(line, NULL, c, state, &error);
-		if (status == CMD_PARSE_ERROR)
-			cmdq_append(c, cmdq_get_callback(control_error, error));
+		status = control_parse_and_append(c, cmd, state, request,
+		    &error);
+		if (status == CMD_PARSE_ERROR) {
+			item = cmdq_get_callback(control_error, error);
+			if (request != NULL)
+				cmdq_set_request(item, request);
+			cmdq_append(c, item);
+		}
 		cmdq_free_state(state);
 
 		free(line);
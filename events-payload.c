@@ -55,8 +55,22 @@ RB_HEAD(event_payload_tree, event_payload_item);
 struct event_payload {
 	struct event_payload_tree	 items;
 	struct cmd_find_state		 target;
+
+	event_payload_fill_cb		 fill_cb;
+	void				*fill_data;
 };
 
+/*
+ * Payloads and items are created and freed for every event, so some freed
+ * ones are kept to be used again.
+ */
+#define EVENT_PAYLOADS 32
+#define EVENT_PAYLOAD_ITEMS 256
+static struct event_payload	 *event_payloads[EVENT_PAYLOADS];
+static u_int			  event_payloads_size;
+static struct event_payload_item *event_payload_items[EVENT_PAYLOAD_ITEMS];
+static u_int			  event_payload_items_size;
+
 static int
 event_payload_cmp(struct event_payload_item *epi1,
     struct event_payload_item *epi2)
@@ -66,12 +80,26 @@ event_payload_cmp(struct event_payload_item *epi1,
 RB_GENERATE_STATIC(event_payload_tree, event_payload_item, entry,
     event_payload_cmp);
 
-/* Find an item. */
+/* Add any items which have not yet been filled in. */
+static void
+event_payload_fill(struct event_payload *ep)
+{
+	event_payload_fill_cb	cb = ep->fill_cb;
+
+	if (cb != NULL) {
+		ep->fill_cb = NULL;
+		cb(ep, ep->fill_data);
+	}
+}
+
+/* Find an item. Internal items (starting with _) never need filling in. */
 static struct event_payload_item *
 event_payload_find(struct event_payload *ep, const char *name)
 {
 	struct event_payload_item	find = { .name = (char *)name };
 
+	if (*name != '_')
+		event_payload_fill(ep);
 	return (RB_FIND(event_payload_tree, &ep->items, &find));
 }
 
@@ -122,6 +150,33 @@ event_payload_free_value(struct event_payload_item *epi)
 	}
 }
 
+/* Create an item. */
+static struct event_payload_item *
+event_payload_new_item(enum event_payload_type type)
+{
+	struct event_payload_item	*epi;
+
+	if (event_payload_items_size != 0) {
+		epi = event_payload_items[--event_payload_items_size];
+		memset(epi, 0, sizeof *epi);
+	} else
+		epi = xcalloc(1, sizeof *epi);
+	epi->type = type;
+	return (epi);
+}
+
+/* Free an item. */
+static void
+event_payload_free_item(struct event_payload_item *epi)
+{
+	event_payload_free_value(epi);
+	free(epi->name);
+	if (event_payload_items_size == EVENT_PAYLOAD_ITEMS)
+		free(epi);
+	else
+		event_payload_items[event_payload_items_size++] = epi;
+}
+
 /* Set an item. */
 static void
 event_payload_set_item(struct event_payload *ep, const char *name,
@@ -133,9 +188,7 @@ event_payload_set_item(struct event_payload *ep, const char *name,
 	old = RB_INSERT(event_payload_tree, &ep->items, new);
 	if (old != NULL) {
 		RB_REMOVE(event_payload_tree, &ep->items, old);
-		event_payload_free_value(old);
-		free(old->name);
-		free(old);
+		event_payload_free_item(old);
 		RB_INSERT(event_payload_tree, &ep->items, new);
 	}
 }
@@ -146,7 +199,11 @@ event_payload_create(void)
 {
 	struct event_payload	*ep;
 
-	ep = xcalloc(1, sizeof *ep);
+	if (event_payloads_size != 0) {
+		ep = event_payloads[--event_payloads_size];
+		memset(ep, 0, sizeof *ep);
+	} else
+		ep = xcalloc(1, sizeof *ep);
 	RB_INIT(&ep->items);
 	cmd_find_clear_state(&ep->target, 0);
 	return (ep);
@@ -161,15 +218,47 @@ event_payload_free(struct event_payload *ep)
 	if (ep != NULL) {
 		RB_FOREACH_SAFE(epi, event_payload_tree, &ep->items, epi1) {
 			RB_REMOVE(event_payload_tree, &ep->items, epi);
-			event_payload_free_value(epi);
-			free(epi->name);
-			free(epi);
+			event_payload_free_item(epi);
 		}
 		event_payload_free_target(ep);
-		free(ep);
+		if (event_payloads_size == EVENT_PAYLOADS)
+			free(ep);
+		else
+			event_payloads[event_payloads_size++] = ep;
 	}
 }
 
+/*
+ * Set a callback to add items the first time they are needed, so an event
+ * nobody looks at does not have to build them.
+ */
+void
+event_payload_set_fill(struct event_payload *ep, event_payload_fill_cb cb,
+    void *data)
+{
+	ep->fill_cb = cb;
+	ep->fill_data = data;
+}
+
+/*
+ * Can a payload be kept after the event is fired? Not if it has a callback to
+ * fill it in or pointers which it does not own, because they may be freed.
+ */
+int
+event_payload_can_keep(struct event_payload *ep)
+{
+	struct event_payload_item	*epi;
+
+	if (ep->fill_cb != NULL)
+		return (0);
+	RB_FOREACH(epi, event_payload_tree, &ep->items) {
+		if (epi->type == EVENT_PAYLOAD_POINTER &&
+		    epi->pointer.free_cb == NULL)
+			return (0);
+	}
+	return (1);
+}
+
 /* Set the target. */
 void
 event_payload_set_target(struct event_payload *ep, struct cmd_find_state *fs)
@@ -203,6 +292,57 @@ event_payload_set_target(struct event_payload *ep, struct cmd_find_state *fs)
 	}
 }
 
+/*
+ * Compare the targets of two payloads, including any client. Only the
+ * pointers are compared; payloads hold references, so they cannot be reused
+ * for another object while either payload exists.
+ */
+int
+event_payload_cmp_target(struct event_payload *ep1, struct event_payload *ep2)
+{
+	struct cmd_find_state	*t1 = &ep1->target, *t2 = &ep2->target;
+	struct client		*c1, *c2;
+
+	if (t1->s != t2->s)
+		return (t1->s < t2->s ? -1 : 1);
+	if (t1->w != t2->w)
+		return (t1->w < t2->w ? -1 : 1);
+	if (t1->wp != t2->wp)
+		return (t1->wp < t2->wp ? -1 : 1);
+	if (t1->idx != t2->idx)
+		return (t1->idx < t2->idx ? -1 : 1);
+	c1 = event_payload_get_client(ep1, "client");
+	c2 = event_payload_get_client(ep2, "client");
+	if (c1 != c2)
+		return (c1 < c2 ? -1 : 1);
+	return (0);
+}
+
+/*
+ * Move items with names starting with old_ from one payload to another, so a
+ * payload replacing an earlier one for the same event keeps the earlier old
+ * values.
+ */
+void
+event_payload_move_old(struct event_payload *to, struct event_payload *from)
+{
+	struct event_payload_item	*epi, *epi1, *old;
+
+	event_payload_fill(from);
+	event_payload_fill(to);
+	RB_FOREACH_SAFE(epi, event_payload_tree, &from->items, epi1) {
+		if (strncmp(epi->name, "old_", 4) != 0)
+			continue;
+		RB_REMOVE(event_payload_tree, &from->items, epi);
+		old = RB_INSERT(event_payload_tree, &to->items, epi);
+		if (old != NULL) {
+			RB_REMOVE(event_payload_tree, &to->items, old);
+			event_payload_free_item(old);
+			RB_INSERT(event_payload_tree, &to->items, epi);
+		}
+	}
+}
+
 /* Get the target. */
 int
 event_payload_get_target(struct event_payload *ep, struct cmd_find_state *fs)
@@ -278,8 +418,7 @@ event_payload_set_string(struct event_payload *ep, const char *name,
 
 	va_start(ap, fmt);
 
-	epi = xcalloc(1, sizeof *epi);
-	epi->type = EVENT_PAYLOAD_STRING;
+	epi = event_payload_new_item(EVENT_PAYLOAD_STRING);
 	xvasprintf(&epi->string, fmt, ap);
 	event_payload_set_item(ep, name, epi);
 
@@ -293,8 +432,7 @@ event_payload_set_time(struct event_payload *ep, const char *name,
 {
 	struct event_payload_item	*epi;
 
-	epi = xcalloc(1, sizeof *epi);
-	epi->type = EVENT_PAYLOAD_TIME;
+	epi = event_payload_new_item(EVENT_PAYLOAD_TIME);
 	epi->time = value;
 	event_payload_set_item(ep, name, epi);
 }
@@ -305,8 +443,7 @@ event_payload_set_int(struct event_payload *ep, const char *name, int value)
 {
 	struct event_payload_item	*epi;
 
-	epi = xcalloc(1, sizeof *epi);
-	epi->type = EVENT_PAYLOAD_INT;
+	epi = event_payload_new_item(EVENT_PAYLOAD_INT);
 	epi->number = value;
 	event_payload_set_item(ep, name, epi);
 }
@@ -317,8 +454,7 @@ event_payload_set_uint(struct event_payload *ep, const char *name, u_int value)
 {
 	struct event_payload_item	*epi;
 
-	epi = xcalloc(1, sizeof *epi);
-	epi->type = EVENT_PAYLOAD_UINT;
+	epi = event_payload_new_item(EVENT_PAYLOAD_UINT);
 	epi->unsigned_number = value;
 	event_payload_set_item(ep, name, epi);
 }
@@ -332,8 +468,7 @@ event_payload_set_client(struct event_payload *ep, const char *name,
 
 	c->references++;
 
-	epi = xcalloc(1, sizeof *epi);
-	epi->type = EVENT_PAYLOAD_CLIENT;
+	epi = event_payload_new_item(EVENT_PAYLOAD_CLIENT);
 	epi->client = c;
 	event_payload_set_item(ep, name, epi);
 }
@@ -347,8 +482,7 @@ event_payload_set_session(struct event_payload *ep, const char *name,
 
 	session_add_ref(s, __func__);
 
-	epi = xcalloc(1, sizeof *epi);
-	epi->type = EVENT_PAYLOAD_SESSION;
+	epi = event_payload_new_item(EVENT_PAYLOAD_SESSION);
 	epi->session = s;
 	event_payload_set_item(ep, name, epi);
 }
@@ -362,8 +496,7 @@ event_payload_set_window(struct event_payload *ep, const char *name,
 
 	window_add_ref(w, __func__);
 
-	epi = xcalloc(1, sizeof *epi);
-	epi->type = EVENT_PAYLOAD_WINDOW;
+	epi = event_payload_new_item(EVENT_PAYLOAD_WINDOW);
 	epi->window = w;
 	event_payload_set_item(ep, name, epi);
 }
@@ -377,8 +510,7 @@ event_payload_set_pane(struct event_payload *ep, const char *name,
 
 	window_pane_add_ref(wp, __func__);
 
-	epi = xcalloc(1, sizeof *epi);
-	epi->type = EVENT_PAYLOAD_PANE;
+	epi = event_payload_new_item(EVENT_PAYLOAD_PANE);
 	epi->pane = wp;
 	event_payload_set_item(ep, name, epi);
 }
@@ -390,8 +522,7 @@ event_payload_set_pointer(struct event_payload *ep, const char *name,
 {
 	struct event_payload_item	*epi;
 
-	epi = xcalloc(1, sizeof *epi);
-	epi->type = EVENT_PAYLOAD_POINTER;
+	epi = event_payload_new_item(EVENT_PAYLOAD_POINTER);
 	epi->pointer.ptr = ptr;
 	epi->pointer.free_cb = free_cb;
 	epi->pointer.print_cb = print_cb;
@@ -492,6 +623,7 @@ event_payload_add_formats(struct event_payload *ep, struct format_tree *ft,
 	if (prefix == NULL)
 		prefix = "";
 
+	event_payload_fill(ep);
 	RB_FOREACH(epi, event_payload_tree, &ep->items) {
 		key = epi->name;
 		if (*key == '_')
@@ -519,6 +651,7 @@ event_payload_add_formats(struct event_payload *ep, struct format_tree *ft,
 struct event_payload_item *
 event_payload_first(struct event_payload *ep)
 {
+	event_payload_fill(ep);
 	return (RB_MIN(event_payload_tree, &ep->items));
 }
 
@@ -560,6 +693,7 @@ event_payload_log(struct event_payload *ep, const char *fmt, ...)
 	if (evb == NULL)
 		fatalx("out of memory");
 	if (ep != NULL) {
+		event_payload_fill(ep);
 		RB_FOREACH(epi, event_payload_tree, &ep->items) {
 			if (EVBUFFER_LENGTH(evb) != 0)
 				evbuffer_add_printf(evb, ", ");
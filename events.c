@@ -25,55 +25,172 @@
 
 /* Event sink. */
 struct events_sink {
-	char				*name;
+	struct events_name		*en;
 	events_cb			 cb;
 	void				*data;
 	int				 dead;
+	int				 inactive;
 	u_int				 generation;
 
 	TAILQ_ENTRY(events_sink)	 entry;
 };
-
 TAILQ_HEAD(events_sinks, events_sink);
-static struct events_sinks events_sinks = TAILQ_HEAD_INITIALIZER(events_sinks);
+
+/* Event sinks for one event name. */
+struct events_name {
+	char				*name;
+	struct events_sinks		 sinks;
+	u_int				 active;
+	int				 coalesce;
+	u_int				 pending;
+
+	RB_ENTRY(events_name)		 entry;
+};
+RB_HEAD(events_names, events_name);
+
+static int	events_name_cmp(struct events_name *, struct events_name *);
+RB_GENERATE_STATIC(events_names, events_name, entry, events_name_cmp);
+static struct events_names events_names = RB_INITIALIZER(&events_names);
+
+/*
+ * Event waiting to be fired at the end of the loop. Events named in the
+ * coalesce-events option are kept until then and a later event with the same
+ * name and target replaces an earlier one.
+ */
+struct events_pending {
+	struct events_name		*en;
+	struct event_payload		*ep;
+
+	TAILQ_ENTRY(events_pending)	 entry;
+	RB_ENTRY(events_pending)	 tree_entry;
+};
+TAILQ_HEAD(events_pending_list, events_pending);
+RB_HEAD(events_pending_tree, events_pending);
+
+static int	events_pending_cmp(struct events_pending *,
+		    struct events_pending *);
+RB_GENERATE_STATIC(events_pending_tree, events_pending, tree_entry,
+    events_pending_cmp);
+static struct events_pending_list events_pending_list =
+    TAILQ_HEAD_INITIALIZER(events_pending_list);
+static struct events_pending_tree events_pending_tree =
+    RB_INITIALIZER(&events_pending_tree);
 
 static u_int events_dispatching;
 static u_int events_generation;
+static u_int events_dead;
+static u_int events_coalesced;
+
+static int
+events_name_cmp(struct events_name *en1, struct events_name *en2)
+{
+	return (strcmp(en1->name, en2->name));
+}
+
+static int
+events_pending_cmp(struct events_pending *ev1, struct events_pending *ev2)
+{
+	if (ev1->en != ev2->en)
+		return (ev1->en < ev2->en ? -1 : 1);
+	return (event_payload_cmp_target(ev1->ep, ev2->ep));
+}
+
+/* Is this event in the coalesce-events option? */
+static int
+events_should_coalesce(const char *name)
+{
+	struct options_entry		*o;
+	struct options_array_item	*a;
+	union options_value		*ov;
+
+	if (global_options == NULL)
+		return (0);
+	o = options_get(global_options, "coalesce-events");
+	if (o == NULL)
+		return (0);
+	a = options_array_first(o);
+	while (a != NULL) {
+		ov = options_array_item_value(a);
+		if (strcmp(ov->string, name) == 0)
+			return (1);
+		a = options_array_next(a);
+	}
+	return (0);
+}
+
+/* Find the sinks for an event name. */
+static struct events_name *
+events_find_name(const char *name)
+{
+	struct events_name	find = { .name = (char *)name };
+
+	return (RB_FIND(events_names, &events_names, &find));
+}
+
+/* Free an event name if it has no sinks and no waiting events. */
+static void
+events_free_name(struct events_name *en)
+{
+	if (TAILQ_EMPTY(&en->sinks) && en->pending == 0) {
+		RB_REMOVE(events_names, &events_names, en);
+		free(en->name);
+		free(en);
+	}
+}
 
-/* Free an event sink. */
+/* Free an event sink and its name if it was the last. */
 static void
 events_free_sink(struct events_sink *es)
 {
-	TAILQ_REMOVE(&events_sinks, es, entry);
-	free(es->name);
+	struct events_name	*en = es->en;
+
+	TAILQ_REMOVE(&en->sinks, es, entry);
 	free(es);
+	events_free_name(en);
 }
 
 /* Free dead event sinks. */
 static void
 events_free_dead(void)
 {
+	struct events_name	*en, *en1;
 	struct events_sink	*es, *es1;
 
-	TAILQ_FOREACH_SAFE(es, &events_sinks, entry, es1) {
-		if (es->dead)
-			events_free_sink(es);
+	if (events_dead == 0)
+		return;
+	RB_FOREACH_SAFE(en, events_names, &events_names, en1) {
+		TAILQ_FOREACH_SAFE(es, &en->sinks, entry, es1) {
+			if (es->dead)
+				events_free_sink(es);
+		}
 	}
+	events_dead = 0;
 }
 
 /* Add an event sink. */
 struct events_sink *
 events_add_sink(const char *name, events_cb cb, void *data)
 {
+	struct events_name	*en;
 	struct events_sink	*es;
 
+	en = events_find_name(name);
+	if (en == NULL) {
+		en = xcalloc(1, sizeof *en);
+		en->name = xstrdup(name);
+		TAILQ_INIT(&en->sinks);
+		en->coalesce = events_should_coalesce(name);
+		RB_INSERT(events_names, &events_names, en);
+	}
+
 	es = xcalloc(1, sizeof *es);
-	es->name = xstrdup(name);
+	es->en = en;
 	es->cb = cb;
 	es->data = data;
 	es->generation = ++events_generation;
 
-	TAILQ_INSERT_TAIL(&events_sinks, es, entry);
+	TAILQ_INSERT_TAIL(&en->sinks, es, entry);
+	en->active++;
 	return (es);
 }
 
@@ -82,16 +199,90 @@ void
 events_remove_sink(struct events_sink *es)
 {
 	if (es != NULL && !es->dead) {
-		if (events_dispatching != 0)
+		if (!es->inactive)
+			es->en->active--;
+		if (events_dispatching != 0) {
 			es->dead = 1;
-		else
+			events_dead++;
+		} else
 			events_free_sink(es);
 	}
 }
 
-/* Fire an event. */
+/*
+ * Set whether an event sink is active. An inactive sink is not called and
+ * does not count as a subscriber, so a sink may be left in place while it has
+ * nothing to do.
+ */
 void
-events_fire(const char *name, struct event_payload *ep)
+events_set_sink_active(struct events_sink *es, int active)
+{
+	if (es->dead || es->inactive == !active)
+		return;
+	es->inactive = !active;
+	if (active)
+		es->en->active++;
+	else
+		es->en->active--;
+}
+
+/* Return if an event has any active sinks. */
+int
+events_has_sinks(const char *name)
+{
+	struct events_name	*en;
+
+	en = events_find_name(name);
+	return (en != NULL && en->active != 0);
+}
+
+/* Update which events are coalesced after the option is changed. */
+void
+events_update_coalesce(void)
+{
+	struct events_name	*en;
+
+	RB_FOREACH(en, events_names, &events_names)
+		en->coalesce = events_should_coalesce(en->name);
+}
+
+/* Get the number of events replaced by a later event. */
+u_int
+events_coalesced_count(void)
+{
+	return (events_coalesced);
+}
+
+/* Keep an event to fire at the end of the loop. */
+static void
+events_add_pending(struct events_name *en, struct event_payload *ep)
+{
+	struct events_pending	 find, *ev;
+
+	find.en = en;
+	find.ep = ep;
+	ev = RB_FIND(events_pending_tree, &events_pending_tree, &find);
+	if (ev != NULL) {
+		log_debug("%s: coalescing %s", __func__, en->name);
+		event_payload_move_old(ep, ev->ep);
+		event_payload_free(ev->ep);
+		ev->ep = ep;
+		events_coalesced++;
+		return;
+	}
+
+	ev = xmalloc(sizeof *ev);
+	ev->en = en;
+	ev->ep = ep;
+	en->pending++;
+	TAILQ_INSERT_TAIL(&events_pending_list, ev, entry);
+	RB_INSERT(events_pending_tree, &events_pending_tree, ev);
+}
+
+/* Fire an event to its sinks. */
+static void
+events_dispatch(struct events_name *en, const char *name,
+    struct event_payload *ep)
 {
 	struct events_sink	*es;
 	u_int			 generation = events_generation;
@@ -101,18 +292,61 @@ events_fire(const char *name, struct event_payload *ep)
 	if (log_get_level() != 0)
 		event_payload_log(ep, "%s: %s: ", __func__, name);
 
-	events_dispatching++;
-	TAILQ_FOREACH(es, &events_sinks, entry) {
-		if (es->dead || es->generation > generation)
-			continue;
-		if (strcmp(es->name, name) == 0)
+	if (en != NULL) {
+		events_dispatching++;
+		TAILQ_FOREACH(es, &en->sinks, entry) {
+			if (es->dead || es->inactive)
+				continue;
+			if (es->generation > generation)
+				continue;
 			es->cb(name, ep, es->data);
+		}
+		if (--events_dispatching == 0)
+			events_free_dead();
 	}
-	if (--events_dispatching == 0)
-		events_free_dead();
 	event_payload_free(ep);
 }
 
+/* Fire an event. */
+void
+events_fire(const char *name, struct event_payload *ep)
+{
+	struct events_name	*en;
+
+	en = events_find_name(name);
+	if ((en == NULL || en->active == 0) && log_get_level() == 0) {
+		event_payload_free(ep);
+		return;
+	}
+	if (en != NULL && en->coalesce && event_payload_can_keep(ep))
+		events_add_pending(en, ep);
+	else
+		events_dispatch(en, name, ep);
+}
+
+/* Fire waiting events. Returns the number fired. */
+u_int
+events_flush(void)
+{
+	struct events_pending	*ev;
+	struct events_name	*en;
+	u_int			 n = 0;
+
+	while ((ev = TAILQ_FIRST(&events_pending_list)) != NULL) {
+		TAILQ_REMOVE(&events_pending_list, ev, entry);
+		RB_REMOVE(events_pending_tree, &events_pending_tree, ev);
+		en = ev->en;
+
+		events_dispatch(en, en->name, ev->ep);
+		free(ev);
+		n++;
+
+		en->pending--;
+		events_free_name(en);
+	}
+	return (n);
+}
+
 /* Fire a client event. */
 void
 events_fire_client(const char *name, struct client *c)
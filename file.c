@@ -17,6 +17,7 @@
  */
 
 #include <sys/types.h>
+#include <sys/stat.h>
 
 #include <errno.h>
 #include <fcntl.h>
@@ -31,10 +32,22 @@
  * IPC file handling. Both client and server use the same data structures
  * (client_file and client_files) to store list of active files. Most functions
  * are for use either in client or server but not both.
+ *
+ * When the client opens a regular file, it passes the file descriptor back
+ * to the server with the MSG_READ_DONE or MSG_WRITE_READY reply. The server
+ * then reads or writes the file itself rather than moving the data through
+ * the client in many small messages. Files larger than FILE_PASS_MAX always
+ * use the messages, so the server does not block for long.
  */
 
 static int	file_next_stream = 3;
 
+/* Amount to read at once from a file passed by the client. */
+#define FILE_READ_SIZE (1024 * 1024)
+
+/* Largest file read or written directly by the server. */
+#define FILE_PASS_MAX (32 * 1024 * 1024)
+
 RB_GENERATE(client_files, client_file, entry, file_cmp);
 
 /* Get path for file, either as given or from working directory. */
@@ -597,6 +610,21 @@ file_write_callback(__unused struct bufferevent *bev, void *arg)
 		cf->cb(NULL, NULL, 0, -1, NULL, cf->data);
 }
 
+/* Check if a client file can be passed to the server (client). */
+static int
+file_can_pass(struct client_file *cf, int reading)
+{
+	struct stat	sb;
+
+	if (cf->stream <= 2)
+		return (0);
+	if (fstat(cf->fd, &sb) != 0 || !S_ISREG(sb.st_mode))
+		return (0);
+	if (reading && sb.st_size > FILE_PASS_MAX)
+		return (0);
+	return (1);
+}
+
 /* Handle a file write open message (client). */
 void
 file_write_open(struct client_files *files, struct tmuxpeer *peer,
@@ -609,7 +637,7 @@ file_write_open(struct client_files *files, struct tmuxpeer *peer,
 	struct msg_write_ready	 reply;
 	struct client_file	 find, *cf;
 	const int		 flags = O_NONBLOCK|O_WRONLY|O_CREAT;
-	int			 error = 0;
+	int			 error = 0, passfd = -1;
 
 	if (msglen < sizeof *msg)
 		fatalx("bad MSG_WRITE_OPEN size");
@@ -653,12 +681,18 @@ file_write_open(struct client_files *files, struct tmuxpeer *peer,
 	if (cf->event == NULL)
 		fatalx("out of memory");
 	bufferevent_enable(cf->event, EV_WRITE);
+
+	/* Let the server write regular files itself. */
+	if (file_can_pass(cf, 0))
+		passfd = dup(cf->fd);
+	if (passfd != -1)
+		log_debug("pass write file %d", cf->stream);
 	goto reply;
 
 reply:
 	reply.stream = msg->stream;
 	reply.error = error;
-	proc_send(peer, MSG_WRITE_READY, -1, &reply, sizeof reply);
+	proc_send(peer, MSG_WRITE_READY, passfd, &reply, sizeof reply);
 }
 
 /* Handle a file write data message (client). */
@@ -805,6 +839,19 @@ file_read_open(struct client_files *files, struct tmuxpeer *peer,
 		goto reply;
 	}
 
+	/* Give regular files to the server to read itself. */
+	if (file_can_pass(cf, 1)) {
+		log_debug("pass read file %d", cf->stream);
+		reply.stream = msg->stream;
+		reply.error = 0;
+		proc_send(peer, MSG_READ_DONE, cf->fd, &reply, sizeof reply);
+
+		cf->fd = -1;
+		RB_REMOVE(client_files, cf->tree, cf);
+		file_free(cf);
+		return;
+	}
+
 	cf->event = bufferevent_new(cf->fd, file_read_callback, NULL,
 	    file_read_error_callback, cf);
 	if (cf->event == NULL)
@@ -836,6 +883,84 @@ file_read_cancel(struct client_files *files, struct imsg *imsg)
 	file_read_error_callback(NULL, 0, cf);
 }
 
+/*
+ * Check a file passed by the client is a regular file (server). Anything else
+ * could block or never finish, so the client is not trusted to check this.
+ */
+static int
+file_passed_is_regular(struct client_file *cf, int fd)
+{
+	struct stat	sb;
+
+	if (fstat(fd, &sb) != 0 || !S_ISREG(sb.st_mode)) {
+		log_debug("file %d passed file is not regular", cf->stream);
+		return (0);
+	}
+	return (1);
+}
+
+/* Write buffered data directly to a file passed by the client (server). */
+static void
+file_write_passed(struct client_file *cf, int fd)
+{
+	size_t	size = EVBUFFER_LENGTH(cf->buffer);
+
+	while (EVBUFFER_LENGTH(cf->buffer) != 0) {
+		if (evbuffer_write(cf->buffer, fd) == -1) {
+			if (errno == EINTR)
+				continue;
+			cf->error = errno;
+			evbuffer_drain(cf->buffer, EVBUFFER_LENGTH(cf->buffer));
+			break;
+		}
+	}
+	if (close(fd) != 0 && cf->error == 0)
+		cf->error = errno;
+	log_debug("file %d wrote %zu bytes directly, error %d", cf->stream,
+	    size, cf->error);
+}
+
+/*
+ * Read a whole file passed by the client (server). The client only passes
+ * files up to FILE_PASS_MAX, so anything larger is an error.
+ */
+static void
+file_read_passed(struct client_file *cf, int fd)
+{
+	struct stat	sb;
+	size_t		total = 0, want;
+	int		n;
+
+	/* Make space for the whole file so it ends up in one piece. */
+	if (fstat(fd, &sb) == 0) {
+		if (sb.st_size > FILE_PASS_MAX)
+			cf->error = EFBIG;
+		else if (sb.st_size > 0)
+			evbuffer_expand(cf->buffer, sb.st_size);
+	}
+
+	while (cf->error == 0) {
+		want = FILE_PASS_MAX + 1 - total;
+		if (want > FILE_READ_SIZE)
+			want = FILE_READ_SIZE;
+		n = evbuffer_read(cf->buffer, fd, want);
+		if (n == 0)
+			break;
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			cf->error = errno;
+			break;
+		}
+		total += n;
+		if (total > FILE_PASS_MAX)
+			cf->error = EFBIG;
+	}
+	close(fd);
+	log_debug("file %d read %zu bytes directly, error %d", cf->stream,
+	    EVBUFFER_LENGTH(cf->buffer), cf->error);
+}
+
 /* Handle a write ready message (server). */
 int
 file_write_ready(struct client_files *files, struct imsg *imsg)
@@ -843,17 +968,37 @@ file_write_ready(struct client_files *files, struct imsg *imsg)
 	struct msg_write_ready	*msg = imsg->data;
 	size_t			 msglen = imsg->hdr.len - IMSG_HEADER_SIZE;
 	struct client_file	 find, *cf;
+	int			 fd = imsg_get_fd(imsg);
 
-	if (msglen != sizeof *msg)
+	if (msglen != sizeof *msg) {
+		if (fd != -1)
+			close(fd);
 		return (-1);
+	}
 	find.stream = msg->stream;
-	if ((cf = RB_FIND(client_files, files, &find)) == NULL)
+	if ((cf = RB_FIND(client_files, files, &find)) == NULL) {
+		if (fd != -1)
+			close(fd);
 		return (0);
+	}
 	if (msg->error != 0) {
+		if (fd != -1)
+			close(fd);
 		cf->error = msg->error;
 		file_fire_done(cf);
-	} else
+	} else {
+		/*
+		 * If the file is not regular or there is too much data to
+		 * write at once, send the data to the client.
+		 */
+		if (fd != -1 &&
+		    EVBUFFER_LENGTH(cf->buffer) <= FILE_PASS_MAX &&
+		    file_passed_is_regular(cf, fd))
+			file_write_passed(cf, fd);
+		else if (fd != -1)
+			close(fd);
 		file_push(cf);
+	}
 	return (0);
 }
 
@@ -874,7 +1019,8 @@ file_write_done(struct client_files *files, struct imsg *imsg)
 		return (0);
 
 	log_debug("file %d write done", cf->stream);
-	cf->error = msg->error;
+	if (cf->error == 0)
+		cf->error = msg->error;
 	file_fire_done(cf);
 	return (0);
 }
@@ -913,15 +1059,34 @@ file_read_done(struct client_files *files, struct imsg *imsg)
 	struct msg_read_done	*msg = imsg->data;
 	size_t			 msglen = imsg->hdr.len - IMSG_HEADER_SIZE;
 	struct client_file	 find, *cf;
+	int			 fd = imsg_get_fd(imsg);
 
-	if (msglen != sizeof *msg)
+	if (msglen != sizeof *msg) {
+		if (fd != -1)
+			close(fd);
 		return (-1);
+	}
 	find.stream = msg->stream;
-	if ((cf = RB_FIND(client_files, files, &find)) == NULL)
+	if ((cf = RB_FIND(client_files, files, &find)) == NULL) {
+		if (fd != -1)
+			close(fd);
 		return (0);
+	}
 
 	log_debug("file %d read done", cf->stream);
 	cf->error = msg->error;
+	if (fd != -1) {
+		/*
+		 * The client has given up the file, so there is nothing to
+		 * fall back to if it is not regular.
+		 */
+		if (cf->error == 0 && !file_passed_is_regular(cf, fd))
+			cf->error = EBADF;
+		if (cf->error == 0 && !cf->closed)
+			file_read_passed(cf, fd);
+		else
+			close(fd);
+	}
 	file_fire_done(cf);
 	return (0);
 }
@@ -52,20 +52,44 @@ static void	 format_defaults_client(struct format_tree *, struct client *);
 static void	 format_defaults_winlink(struct format_tree *,
 		     struct winlink *);
 
-/* Entry in format job tree. */
-struct format_job {
-	struct client		*client;
-	u_int			 tag;
+/*
+ * Result of a format job. This is shared by all entries in the format job
+ * trees with the same expanded command and working directory, so the command
+ * is only run once however many clients or sessions are using it.
+ */
+struct format_job_result {
 	const char		*cmd;
-	const char		*expanded;
+	const char		*cwd;
 
 	time_t			 last;
 	char			*out;
 	int			 updated;
 
 	struct job		*job;
+	struct timeval		 started;
+	u_int			 runtime;
+	uint64_t		 total;
+	u_int			 runs;
+	u_int			 hits;
 	int			 status;
 
+	LIST_HEAD(, format_job)	 sharers;
+	u_int			 nsharers;
+
+	RB_ENTRY(format_job_result) entry;
+};
+
+/* Entry in format job tree. */
+struct format_job {
+	struct client		*client;
+	u_int			 tag;
+	const char		*cmd;
+
+	time_t			 last;
+	struct format_job_result *result;
+	int			 status;
+
+	LIST_ENTRY(format_job)	 sharer_entry;
 	RB_ENTRY(format_job)	 entry;
 };
 
@@ -85,6 +109,26 @@ format_job_cmp(struct format_job *fj1, struct format_job *fj2)
 	return (strcmp(fj1->cmd, fj2->cmd));
 }
 
+/* Format job result tree. */
+static int format_job_result_cmp(struct format_job_result *,
+    struct format_job_result *);
+static RB_HEAD(format_job_result_tree, format_job_result) format_job_results =
+    RB_INITIALIZER();
+RB_GENERATE_STATIC(format_job_result_tree, format_job_result, entry,
+    format_job_result_cmp);
+
+/* Format job result tree comparison function. */
+static int
+format_job_result_cmp(struct format_job_result *fjr1,
+    struct format_job_result *fjr2)
+{
+	int	result;
+
+	if ((result = strcmp(fjr1->cmd, fjr2->cmd)) != 0)
+		return (result);
+	return (strcmp(fjr1->cwd, fjr2->cwd));
+}
+
 /* Maximum pad and trim width. */
 #define FORMAT_MAX_WIDTH 10000
 
@@ -320,14 +364,30 @@ format_copy_state(struct format_expand_state *to,
 	to->start_time = from->start_time;
 }
 
+/* Redraw the status line of clients sharing a format job. */
+static void
+format_job_redraw(struct format_job_result *fjr, int clear)
+{
+	struct format_job	*fj;
+
+	LIST_FOREACH(fj, &fjr->sharers, sharer_entry) {
+		if (!fj->status)
+			continue;
+		if (fj->client != NULL)
+			server_status_client(fj->client);
+		if (clear)
+			fj->status = 0;
+	}
+}
+
 /* Format job update callback. */
 static void
 format_job_update(struct job *job)
 {
-	struct format_job	*fj = job_get_data(job);
-	struct evbuffer		*evb = job_get_event(job)->input;
-	char			*line = NULL, *next;
-	time_t			 t;
+	struct format_job_result	*fjr = job_get_data(job);
+	struct evbuffer			*evb = job_get_event(job)->input;
+	char				*line = NULL, *next;
+	time_t				 t;
 
 	while ((next = evbuffer_readline(evb)) != NULL) {
 		free(line);
@@ -335,18 +395,17 @@ format_job_update(struct job *job)
 	}
 	if (line == NULL)
 		return;
-	fj->updated = 1;
+	fjr->updated = 1;
 
-	free(fj->out);
-	fj->out = line;
+	free(fjr->out);
+	fjr->out = line;
 
-	log_debug("%s: %p %s: %s", __func__, fj, fj->cmd, fj->out);
+	log_debug("%s: %p %s: %s", __func__, fjr, fjr->cmd, fjr->out);
 
 	t = time(NULL);
-	if (fj->status && fj->last != t) {
-		if (fj->client != NULL)
-			server_status_client(fj->client);
-		fj->last = t;
+	if (fjr->last != t) {
+		format_job_redraw(fjr, 0);
+		fjr->last = t;
 	}
 }
 
@@ -354,12 +413,20 @@ format_job_update(struct job *job)
 static void
 format_job_complete(struct job *job)
 {
-	struct format_job	*fj = job_get_data(job);
-	struct evbuffer		*evb = job_get_event(job)->input;
-	char			*line, *buf;
-	size_t			 len;
+	struct format_job_result	*fjr = job_get_data(job);
+	struct evbuffer			*evb = job_get_event(job)->input;
+	char				*line, *buf;
+	size_t				 len;
+	struct timeval			 tv;
+
+	fjr->job = NULL;
 
-	fj->job = NULL;
+	gettimeofday(&tv, NULL);
+	timersub(&tv, &fjr->started, &tv);
+	fjr->runtime = tv.tv_sec * 1000 + tv.tv_usec / 1000;
+	fjr->total += fjr->runtime;
+	fjr->runs++;
+	fjr->status = job_get_status(job);
 
 	buf = NULL;
 	if ((line = evbuffer_readline(evb)) == NULL) {
@@ -371,19 +438,66 @@ format_job_complete(struct job *job)
 	} else
 		buf = line;
 
-	log_debug("%s: %p %s: %s", __func__, fj, fj->cmd, buf);
+	log_debug("%s: %p %s: %s (%u ms)", __func__, fjr, fjr->cmd, buf,
+	    fjr->runtime);
 
-	if (*buf != '\0' || !fj->updated) {
-		free(fj->out);
-		fj->out = buf;
+	if (*buf != '\0' || !fjr->updated) {
+		free(fjr->out);
+		fjr->out = buf;
 	} else
 		free(buf);
 
-	if (fj->status) {
-		if (fj->client != NULL)
-			server_status_client(fj->client);
-		fj->status = 0;
+	format_job_redraw(fjr, 1);
+}
+
+/* Stop sharing a format job result, freeing it if it was the last user. */
+static void
+format_job_detach(struct format_job *fj)
+{
+	struct format_job_result	*fjr = fj->result;
+
+	if (fjr == NULL)
+		return;
+	fj->result = NULL;
+
+	LIST_REMOVE(fj, sharer_entry);
+	if (--fjr->nsharers != 0)
+		return;
+	RB_REMOVE(format_job_result_tree, &format_job_results, fjr);
+
+	log_debug("%s: %s", __func__, fjr->cmd);
+
+	if (fjr->job != NULL)
+		job_free(fjr->job);
+
+	free((void *)fjr->cmd);
+	free((void *)fjr->cwd);
+	free(fjr->out);
+
+	free(fjr);
+}
+
+/* Share the format job result for a command, creating it if needed. */
+static void
+format_job_attach(struct format_job *fj, const char *cmd, const char *cwd)
+{
+	struct format_job_result	 fjr0, *fjr;
+
+	fjr0.cmd = cmd;
+	fjr0.cwd = cwd;
+	if ((fjr = RB_FIND(format_job_result_tree, &format_job_results,
+	    &fjr0)) == NULL) {
+		fjr = xcalloc(1, sizeof *fjr);
+		fjr->cmd = xstrdup(cmd);
+		fjr->cwd = xstrdup(cwd);
+		LIST_INIT(&fjr->sharers);
+
+		RB_INSERT(format_job_result_tree, &format_job_results, fjr);
 	}
+
+	LIST_INSERT_HEAD(&fjr->sharers, fj, sharer_entry);
+	fjr->nsharers++;
+	fj->result = fjr;
 }
 
 /* Find a job. */
@@ -393,9 +507,10 @@ format_job_get(struct format_expand_state *es, const char *cmd)
 	struct format_tree		*ft = es->ft;
 	struct format_job_tree		*jobs;
 	struct format_job		 fj0, *fj;
+	struct format_job_result	*fjr;
 	time_t				 t;
 	char				*expanded;
-	int				 force;
+	const char			*cwd;
 	struct format_expand_state	 next;
 
 	if (ft->client == NULL)
@@ -423,35 +538,46 @@ format_job_get(struct format_expand_state *es, const char *cmd)
 	next.flags &= ~FORMAT_EXPAND_TIME;
 
 	expanded = format_expand1(&next, cmd);
-	if (fj->expanded == NULL || strcmp(expanded, fj->expanded) != 0) {
-		free((void *)fj->expanded);
-		fj->expanded = xstrdup(expanded);
-		force = 1;
-	} else
-		force = (ft->flags & FORMAT_FORCE);
+	cwd = server_client_get_cwd(ft->client, NULL);
+	fjr = fj->result;
+	if (fjr == NULL ||
+	    strcmp(expanded, fjr->cmd) != 0 ||
+	    strcmp(cwd, fjr->cwd) != 0) {
+		format_job_detach(fj);
+		format_job_attach(fj, expanded, cwd);
+		fjr = fj->result;
+	}
+	free(expanded);
 
+	/*
+	 * Only start the job if it is not already running; anyone else asking
+	 * for it in the meantime gets the last output.
+	 */
 	t = time(NULL);
-	if (force && fj->job != NULL)
-	       job_free(fj->job);
-	if (force || (fj->job == NULL && fj->last != t)) {
-		fj->job = job_run(expanded, 0, NULL, NULL, NULL,
-		    server_client_get_cwd(ft->client, NULL), format_job_update,
-		    format_job_complete, NULL, fj, JOB_NOWAIT, -1, -1);
-		if (fj->job == NULL) {
-			free(fj->out);
-			xasprintf(&fj->out, "<'%s' didn't start>", fj->cmd);
+	fj->last = t;
+	if (fjr->job == NULL &&
+	    ((ft->flags & FORMAT_FORCE) || fjr->last != t)) {
+		gettimeofday(&fjr->started, NULL);
+		fjr->job = job_run(fjr->cmd, 0, NULL, NULL, NULL, fjr->cwd,
+		    format_job_update, format_job_complete, NULL, fjr,
+		    JOB_NOWAIT|JOB_POOL, -1, -1);
+		if (fjr->job == NULL) {
+			free(fjr->out);
+			xasprintf(&fjr->out, "<'%s' didn't start>", fj->cmd);
 		}
-		fj->last = t;
-		fj->updated = 0;
-	} else if (fj->job != NULL && (t - fj->last) > 1 && fj->out == NULL)
-		xasprintf(&fj->out, "<'%s' not ready>", fj->cmd);
-	free(expanded);
+		fjr->last = t;
+		fjr->updated = 0;
+	} else {
+		fjr->hits++;
+		if (fjr->job != NULL && (t - fjr->last) > 1 && fjr->out == NULL)
+			xasprintf(&fjr->out, "<'%s' not ready>", fj->cmd);
+	}
 
 	if (ft->flags & FORMAT_STATUS)
 		fj->status = 1;
-	if (fj->out == NULL)
+	if (fjr->out == NULL)
 		return (xstrdup(""));
-	return (format_expand1(&next, fj->out));
+	return (format_expand1(&next, fjr->out));
 }
 
 /* Remove old jobs. */
@@ -469,17 +595,49 @@ format_job_tidy(struct format_job_tree *jobs, int force)
 
 		log_debug("%s: %s", __func__, fj->cmd);
 
-		if (fj->job != NULL)
-			job_free(fj->job);
-
-		free((void *)fj->expanded);
+		format_job_detach(fj);
 		free((void *)fj->cmd);
-		free(fj->out);
 
 		free(fj);
 	}
 }
 
+/* Print format jobs and their results. */
+int
+format_print_jobs(struct cmdq_item *item, int blank)
+{
+	struct format_job_result	*fjr;
+	u_int				 n = 0, average;
+	char				 status[32];
+
+	RB_FOREACH(fjr, format_job_result_tree, &format_job_results) {
+		if (blank) {
+			cmdq_print(item, "%s", "");
+			blank = 0;
+		}
+		if (fjr->runs == 0)
+			average = 0;
+		else
+			average = fjr->total / fjr->runs;
+		if (fjr->runs == 0)
+			*status = '\0';
+		else if (WIFSIGNALED(fjr->status)) {
+			xsnprintf(status, sizeof status, ", signal %d",
+			    WTERMSIG(fjr->status));
+		} else {
+			xsnprintf(status, sizeof status, ", exit %d",
+			    WEXITSTATUS(fjr->status));
+		}
+		cmdq_print(item, "Format job %u: %s [cwd=%s, sharers=%u, "
+		    "runs=%u, hits=%u, last=%u ms, average=%u ms%s%s]", n,
+		    fjr->cmd, fjr->cwd, fjr->nsharers, fjr->runs, fjr->hits,
+		    fjr->runtime, average, status,
+		    fjr->job != NULL ? ", running" : "");
+		n++;
+	}
+	return (n != 0);
+}
+
 /* Work around needless -Wformat-nonliteral gcc warning. */
 #ifdef __GNUC__
 #pragma GCC diagnostic push
@@ -939,19 +1097,19 @@ static void *
 format_cb_current_command(struct format_tree *ft)
 {
 	struct window_pane	*wp = ft->wp;
+	const char		*name;
 	char			*cmd, *value;
 
 	if (wp == NULL || wp->shell == NULL)
 		return (NULL);
 
-	cmd = osdep_get_name(wp->fd, wp->tty);
+	if ((name = get_pane_command(wp)) != NULL && *name != '\0')
+		return (parse_window_name(name));
+
+	cmd = cmd_stringify_argv(wp->argc, wp->argv);
 	if (cmd == NULL || *cmd == '\0') {
 		free(cmd);
-		cmd = cmd_stringify_argv(wp->argc, wp->argv);
-		if (cmd == NULL || *cmd == '\0') {
-			free(cmd);
-			cmd = xstrdup(wp->shell);
-		}
+		cmd = xstrdup(wp->shell);
 	}
 	value = parse_window_name(cmd);
 	free(cmd);
@@ -963,12 +1121,12 @@ static void *
 format_cb_current_path(struct format_tree *ft)
 {
 	struct window_pane	*wp = ft->wp;
-	char			*cwd;
+	const char		*cwd;
 
 	if (wp == NULL)
 		return (NULL);
 
-	cwd = osdep_get_cwd(wp->fd);
+	cwd = get_pane_cwd(wp, !(ft->flags & FORMAT_STATUS));
 	if (cwd == NULL)
 		return (NULL);
 	return (xstrdup(cwd));
@@ -2379,6 +2537,46 @@ format_cb_pane_height(struct format_tree *ft)
 	return (NULL);
 }
 
+/* Callback for pane_image_bytes. */
+static void *
+format_cb_pane_image_bytes(struct format_tree *ft)
+{
+#ifdef ENABLE_SIXEL
+	u_int	count;
+	size_t	size;
+
+	if (ft->wp != NULL) {
+		image_stats(&ft->wp->base, &count, &size);
+		return (format_printf("%zu", size));
+	}
+	return (NULL);
+#else
+	if (ft->wp != NULL)
+		return (xstrdup("0"));
+	return (NULL);
+#endif
+}
+
+/* Callback for pane_images. */
+static void *
+format_cb_pane_images(struct format_tree *ft)
+{
+#ifdef ENABLE_SIXEL
+	u_int	count;
+	size_t	size;
+
+	if (ft->wp != NULL) {
+		image_stats(&ft->wp->base, &count, &size);
+		return (format_printf("%u", count));
+	}
+	return (NULL);
+#else
+	if (ft->wp != NULL)
+		return (xstrdup("0"));
+	return (NULL);
+#endif
+}
+
 /* Callback for pane_id. */
 static void *
 format_cb_pane_id(struct format_tree *ft)
@@ -2500,6 +2698,33 @@ format_cb_pane_mode(struct format_tree *ft)
 	return (NULL);
 }
 
+/* Callback for pane_paste_progress. */
+static void *
+format_cb_pane_paste_progress(struct format_tree *ft)
+{
+	size_t	done, size;
+
+	if (ft->wp != NULL) {
+		paste_progress(ft->wp, &done, &size);
+		if (size == 0)
+			return (xstrdup("0"));
+		return (format_printf("%u", (u_int)((done * 100) / size)));
+	}
+	return (NULL);
+}
+
+/* Callback for pane_pasting. */
+static void *
+format_cb_pane_pasting(struct format_tree *ft)
+{
+	if (ft->wp != NULL) {
+		if (!TAILQ_EMPTY(&ft->wp->pastes))
+			return (xstrdup("1"));
+		return (xstrdup("0"));
+	}
+	return (NULL);
+}
+
 /* Callback for pane_path. */
 static void *
 format_cb_pane_path(struct format_tree *ft)
@@ -2784,6 +3009,124 @@ format_cb_scroll_region_upper(struct format_tree *ft)
 	return (NULL);
 }
 
+/* Callback for server_buffer_bytes. */
+static void *
+format_cb_server_buffer_bytes(__unused struct format_tree *ft)
+{
+	size_t	stored, saved;
+
+	paste_stats(&stored, &saved);
+	return (format_printf("%zu", stored));
+}
+
+/* Callback for server_buffer_saved_bytes. */
+static void *
+format_cb_server_buffer_saved_bytes(__unused struct format_tree *ft)
+{
+	size_t	stored, saved;
+
+	paste_stats(&stored, &saved);
+	return (format_printf("%zu", saved));
+}
+
+/* Callback for server_command_lookup_rate. */
+static void *
+format_cb_server_command_lookup_rate(__unused struct format_tree *ft)
+{
+	u_int	total, last;
+
+	name_lookup_stats(&total, &last);
+	return (format_printf("%u", last));
+}
+
+/* Callback for server_command_lookups. */
+static void *
+format_cb_server_command_lookups(__unused struct format_tree *ft)
+{
+	u_int	total, last;
+
+	name_lookup_stats(&total, &last);
+	return (format_printf("%u", total));
+}
+
+/* Callback for server_control_parse_hits. */
+static void *
+format_cb_server_control_parse_hits(__unused struct format_tree *ft)
+{
+	u_int	hits, misses;
+
+	control_parse_stats(&hits, &misses);
+	return (format_printf("%u", hits));
+}
+
+/* Callback for server_control_parse_misses. */
+static void *
+format_cb_server_control_parse_misses(__unused struct format_tree *ft)
+{
+	u_int	hits, misses;
+
+	control_parse_stats(&hits, &misses);
+	return (format_printf("%u", misses));
+}
+
+/* Callback for server_events_coalesced. */
+static void *
+format_cb_server_events_coalesced(__unused struct format_tree *ft)
+{
+	return (format_printf("%u", events_coalesced_count()));
+}
+
+/* Callback for server_image_bytes. */
+static void *
+format_cb_server_image_bytes(__unused struct format_tree *ft)
+{
+#ifdef ENABLE_SIXEL
+	u_int	count;
+	size_t	size;
+
+	image_stats(NULL, &count, &size);
+	return (format_printf("%zu", size));
+#else
+	return (xstrdup("0"));
+#endif
+}
+
+/* Callback for server_images. */
+static void *
+format_cb_server_images(__unused struct format_tree *ft)
+{
+#ifdef ENABLE_SIXEL
+	u_int	count;
+	size_t	size;
+
+	image_stats(NULL, &count, &size);
+	return (format_printf("%u", count));
+#else
+	return (xstrdup("0"));
+#endif
+}
+
+/* Callback for server_key_trees. */
+static void *
+format_cb_server_key_trees(__unused struct format_tree *ft)
+{
+	return (format_printf("%u", tty_keys_trees_built()));
+}
+
+/* Callback for server_reflow_pending. */
+static void *
+format_cb_server_reflow_pending(__unused struct format_tree *ft)
+{
+	return (format_printf("%u", window_pane_reflow_pending()));
+}
+
+/* Callback for server_resizes_avoided. */
+static void *
+format_cb_server_resizes_avoided(__unused struct format_tree *ft)
+{
+	return (format_printf("%u", resize_avoided_count()));
+}
+
 /* Callback for server_sessions. */
 static void *
 format_cb_server_sessions(__unused struct format_tree *ft)
@@ -2796,6 +3139,28 @@ format_cb_server_sessions(__unused struct format_tree *ft)
 	return (format_printf("%u", n));
 }
 
+/* Callback for server_size_recalculation_time. */
+static void *
+format_cb_server_size_recalculation_time(__unused struct format_tree *ft)
+{
+	u_int		count;
+	uint64_t	usec;
+
+	recalculate_sizes_stats(&count, &usec);
+	return (format_printf("%llu", (unsigned long long)usec));
+}
+
+/* Callback for server_size_recalculations. */
+static void *
+format_cb_server_size_recalculations(__unused struct format_tree *ft)
+{
+	u_int		count;
+	uint64_t	usec;
+
+	recalculate_sizes_stats(&count, &usec);
+	return (format_printf("%u", count));
+}
+
 /* Callback for session_active. */
 static void *
 format_cb_session_active(struct format_tree *ft)
@@ -3018,6 +3383,111 @@ format_cb_sixel_support(__unused struct format_tree *ft)
 #endif
 }
 
+/* Callback for job_pool_average. */
+static void *
+format_cb_job_pool_average(__unused struct format_tree *ft)
+{
+	u_int	workers, busy, queued, runs, last, average;
+
+	job_pool_stats(&workers, &busy, &queued, &runs, &last, &average);
+	return (format_printf("%u", average));
+}
+
+/* Callback for job_pool_busy. */
+static void *
+format_cb_job_pool_busy(__unused struct format_tree *ft)
+{
+	u_int	workers, busy, queued, runs, last, average;
+
+	job_pool_stats(&workers, &busy, &queued, &runs, &last, &average);
+	return (format_printf("%u", busy));
+}
+
+/* Callback for job_pool_last. */
+static void *
+format_cb_job_pool_last(__unused struct format_tree *ft)
+{
+	u_int	workers, busy, queued, runs, last, average;
+
+	job_pool_stats(&workers, &busy, &queued, &runs, &last, &average);
+	return (format_printf("%u", last));
+}
+
+/* Callback for job_pool_queued. */
+static void *
+format_cb_job_pool_queued(__unused struct format_tree *ft)
+{
+	u_int	workers, busy, queued, runs, last, average;
+
+	job_pool_stats(&workers, &busy, &queued, &runs, &last, &average);
+	return (format_printf("%u", queued));
+}
+
+/* Callback for job_pool_runs. */
+static void *
+format_cb_job_pool_runs(__unused struct format_tree *ft)
+{
+	u_int	workers, busy, queued, runs, last, average;
+
+	job_pool_stats(&workers, &busy, &queued, &runs, &last, &average);
+	return (format_printf("%u", runs));
+}
+
+/* Callback for job_pool_workers. */
+static void *
+format_cb_job_pool_workers(__unused struct format_tree *ft)
+{
+	u_int	workers, busy, queued, runs, last, average;
+
+	job_pool_stats(&workers, &busy, &queued, &runs, &last, &average);
+	return (format_printf("%u", workers));
+}
+
+/* Callback for image_cache_hits. */
+static void *
+format_cb_image_cache_hits(__unused struct format_tree *ft)
+{
+#ifdef ENABLE_SIXEL
+	u_int	hits, misses, count;
+	size_t	size;
+
+	image_cache_stats(&hits, &misses, &count, &size);
+	return (format_printf("%u", hits));
+#else
+	return (xstrdup("0"));
+#endif
+}
+
+/* Callback for image_cache_misses. */
+static void *
+format_cb_image_cache_misses(__unused struct format_tree *ft)
+{
+#ifdef ENABLE_SIXEL
+	u_int	hits, misses, count;
+	size_t	size;
+
+	image_cache_stats(&hits, &misses, &count, &size);
+	return (format_printf("%u", misses));
+#else
+	return (xstrdup("0"));
+#endif
+}
+
+/* Callback for image_cache_size. */
+static void *
+format_cb_image_cache_size(__unused struct format_tree *ft)
+{
+#ifdef ENABLE_SIXEL
+	u_int	hits, misses, count;
+	size_t	size;
+
+	image_cache_stats(&hits, &misses, &count, &size);
+	return (format_printf("%zu", size));
+#else
+	return (xstrdup("0"));
+#endif
+}
+
 /* Callback for active_window_index. */
 static void *
 format_cb_active_window_index(struct format_tree *ft)
@@ -3681,9 +4151,36 @@ static const struct format_table_entry format_table[] = {
 	{ "host_short", FORMAT_TABLE_STRING,
 	  format_cb_host_short
 	},
+	{ "image_cache_hits", FORMAT_TABLE_STRING,
+	  format_cb_image_cache_hits
+	},
+	{ "image_cache_misses", FORMAT_TABLE_STRING,
+	  format_cb_image_cache_misses
+	},
+	{ "image_cache_size", FORMAT_TABLE_STRING,
+	  format_cb_image_cache_size
+	},
 	{ "insert_flag", FORMAT_TABLE_STRING,
 	  format_cb_insert_flag
 	},
+	{ "job_pool_average", FORMAT_TABLE_STRING,
+	  format_cb_job_pool_average
+	},
+	{ "job_pool_busy", FORMAT_TABLE_STRING,
+	  format_cb_job_pool_busy
+	},
+	{ "job_pool_last", FORMAT_TABLE_STRING,
+	  format_cb_job_pool_last
+	},
+	{ "job_pool_queued", FORMAT_TABLE_STRING,
+	  format_cb_job_pool_queued
+	},
+	{ "job_pool_runs", FORMAT_TABLE_STRING,
+	  format_cb_job_pool_runs
+	},
+	{ "job_pool_workers", FORMAT_TABLE_STRING,
+	  format_cb_job_pool_workers
+	},
 	{ "keypad_cursor_flag", FORMAT_TABLE_STRING,
 	  format_cb_keypad_cursor_flag
 	},
@@ -3813,6 +4310,12 @@ static const struct format_table_entry format_table[] = {
 	{ "pane_id", FORMAT_TABLE_STRING,
 	  format_cb_pane_id
 	},
+	{ "pane_image_bytes", FORMAT_TABLE_STRING,
+	  format_cb_pane_image_bytes
+	},
+	{ "pane_images", FORMAT_TABLE_STRING,
+	  format_cb_pane_images
+	},
 	{ "pane_in_mode", FORMAT_TABLE_STRING,
 	  format_cb_pane_in_mode
 	},
@@ -3849,6 +4352,12 @@ static const struct format_table_entry format_table[] = {
 	{ "pane_mode", FORMAT_TABLE_STRING,
 	  format_cb_pane_mode
 	},
+	{ "pane_paste_progress", FORMAT_TABLE_STRING,
+	  format_cb_pane_paste_progress
+	},
+	{ "pane_pasting", FORMAT_TABLE_STRING,
+	  format_cb_pane_pasting
+	},
 	{ "pane_path", FORMAT_TABLE_STRING,
 	  format_cb_pane_path
 	},
@@ -3933,9 +4442,51 @@ static const struct format_table_entry format_table[] = {
 	{ "scroll_region_upper", FORMAT_TABLE_STRING,
 	  format_cb_scroll_region_upper
 	},
+	{ "server_buffer_bytes", FORMAT_TABLE_STRING,
+	  format_cb_server_buffer_bytes
+	},
+	{ "server_buffer_saved_bytes", FORMAT_TABLE_STRING,
+	  format_cb_server_buffer_saved_bytes
+	},
+	{ "server_command_lookup_rate", FORMAT_TABLE_STRING,
+	  format_cb_server_command_lookup_rate
+	},
+	{ "server_command_lookups", FORMAT_TABLE_STRING,
+	  format_cb_server_command_lookups
+	},
+	{ "server_control_parse_hits", FORMAT_TABLE_STRING,
+	  format_cb_server_control_parse_hits
+	},
+	{ "server_control_parse_misses", FORMAT_TABLE_STRING,
+	  format_cb_server_control_parse_misses
+	},
+	{ "server_events_coalesced", FORMAT_TABLE_STRING,
+	  format_cb_server_events_coalesced
+	},
+	{ "server_image_bytes", FORMAT_TABLE_STRING,
+	  format_cb_server_image_bytes
+	},
+	{ "server_images", FORMAT_TABLE_STRING,
+	  format_cb_server_images
+	},
+	{ "server_key_trees", FORMAT_TABLE_STRING,
+	  format_cb_server_key_trees
+	},
+	{ "server_reflow_pending", FORMAT_TABLE_STRING,
+	  format_cb_server_reflow_pending
+	},
+	{ "server_resizes_avoided", FORMAT_TABLE_STRING,
+	  format_cb_server_resizes_avoided
+	},
 	{ "server_sessions", FORMAT_TABLE_STRING,
 	  format_cb_server_sessions
 	},
+	{ "server_size_recalculation_time", FORMAT_TABLE_STRING,
+	  format_cb_server_size_recalculation_time
+	},
+	{ "server_size_recalculations", FORMAT_TABLE_STRING,
+	  format_cb_server_size_recalculations
+	},
 	{ "session_active", FORMAT_TABLE_STRING,
 	  format_cb_session_active
 	},
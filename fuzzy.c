@@ -74,8 +74,30 @@ struct fuzzy_term {
 	int			 exact;
 	int			 prefix;
 	int			 suffix;
-	const char		*text;
-	size_t			 len;
+	struct utf8_data	*tok;		/* decoded characters */
+	u_int			 toklen;
+};
+
+/* One AND group of terms. */
+struct fuzzy_group {
+	int			 valid;
+	struct fuzzy_term	*terms;
+	u_int			 nterms;
+};
+
+/* A compiled pattern. */
+struct fuzzy_pattern {
+	int			 empty;
+	int			 fold;
+	struct fuzzy_group	*groups;
+	u_int			 ngroups;
+};
+
+/* A scanned text. */
+struct fuzzy_text {
+	struct fuzzy_char	*cs;
+	u_int			 ncs;
+	u_int			 widths[STYLE_ALIGN_ABSOLUTE_CENTRE + 1];
 };
 
 /* Is this character a word boundary, so a match after it scores higher? */
@@ -461,27 +483,25 @@ fuzzy_parse_term(const char *start, const char *end, struct fuzzy_term *term)
 
 	if (term->inverse)
 		term->exact = 1;
-	term->text = start;
-	term->len = end - start;
+	term->tok = xreallocarray(NULL, end - start, sizeof *term->tok);
+	term->toklen = fuzzy_decode(start, end - start, term->tok);
 	return (1);
 }
 
 /* Match one parsed term. */
 static int
-fuzzy_match_term(const struct fuzzy_term *term, struct utf8_data *tok,
-    struct fuzzy_char *cs, u_int ncs, int fold, int *score, char *matched)
+fuzzy_match_term(const struct fuzzy_term *term, struct fuzzy_char *cs,
+    u_int ncs, int fold, int *score, char *matched)
 {
-	u_int	toklen;
 	int	value = 0, matched_term;
 
-	toklen = fuzzy_decode(term->text, term->len, tok);
 	if (term->exact) {
-		matched_term = fuzzy_match_exact(tok, toklen, cs, ncs, fold,
-		    term->prefix, term->suffix, &value,
+		matched_term = fuzzy_match_exact(term->tok, term->toklen, cs,
+		    ncs, fold, term->prefix, term->suffix, &value,
 		    term->inverse ? NULL : matched);
 	} else {
-		matched_term = fuzzy_match_fuzzy(tok, toklen, cs, ncs, fold,
-		    &value, term->inverse ? NULL : matched);
+		matched_term = fuzzy_match_fuzzy(term->tok, term->toklen, cs,
+		    ncs, fold, &value, term->inverse ? NULL : matched);
 	}
 
 	if (term->inverse)
@@ -492,16 +512,14 @@ fuzzy_match_term(const struct fuzzy_term *term, struct utf8_data *tok,
 	return (1);
 }
 
-/* Match one AND group of terms. */
-static int
-fuzzy_match_group(const char *start, const char *end, struct utf8_data *tok,
-    struct fuzzy_char *cs, u_int ncs, int fold, int *score, char *matched)
+/* Parse one AND group of terms. */
+static void
+fuzzy_parse_group(const char *start, const char *end, struct fuzzy_group *fg)
 {
 	const char		*cp = start, *sp;
 	struct fuzzy_term	 term;
-	int			 any = 0;
 
-	*score = 0;
+	memset(fg, 0, sizeof *fg);
 	while (cp != end) {
 		while (cp != end && *cp == ' ')
 			cp++;
@@ -510,66 +528,72 @@ fuzzy_match_group(const char *start, const char *end, struct utf8_data *tok,
 		sp = cp;
 		while (cp != end && *cp != ' ')
 			cp++;
-		if (!fuzzy_parse_term(sp, cp, &term))
-			return (0);
-		any = 1;
-		if (!fuzzy_match_term(&term, tok, cs, ncs, fold, score,
+		if (!fuzzy_parse_term(sp, cp, &term)) {
+			fg->valid = 0;
+			return;
+		}
+		fg->terms = xreallocarray(fg->terms, fg->nterms + 1,
+		    sizeof *fg->terms);
+		memcpy(&fg->terms[fg->nterms++], &term, sizeof term);
+		fg->valid = 1;
+	}
+}
+
+/* Match one AND group of terms. */
+static int
+fuzzy_match_group(const struct fuzzy_group *fg, struct fuzzy_char *cs,
+    u_int ncs, int fold, int *score, char *matched)
+{
+	u_int	i;
+
+	*score = 0;
+	if (!fg->valid)
+		return (0);
+	for (i = 0; i < fg->nterms; i++) {
+		if (!fuzzy_match_term(&fg->terms[i], cs, ncs, fold, score,
 		    matched))
 			return (0);
 	}
-	return (any);
+	return (1);
+}
+
+/* Does a pattern have an uppercase character, which turns off case folding? */
+static int
+fuzzy_has_upper(const char *pattern)
+{
+	const char	*cp;
+
+	for (cp = pattern; *cp != '\0'; cp++) {
+		if (*cp >= 'A' && *cp <= 'Z')
+			return (1);
+	}
+	return (0);
 }
 
 /*
- * Fuzzy match pattern against text, which is drawn into a region of the given
- * display width. Returns a bitstr_t of width bits with a bit set for each
- * column occupied by a matched character, or NULL if there is no match. A
- * higher returned score is better.
+ * Compile a pattern so it can be matched against many texts without parsing
+ * it again.
  */
-bitstr_t *
-fuzzy_match(const char *pattern, const char *text, u_int width, u_int *score)
+struct fuzzy_pattern *
+fuzzy_pattern_create(const char *pattern)
 {
-	struct fuzzy_char	*cs;
-	char			*matched = NULL, *best = NULL, *groupmatched;
-	struct utf8_data	*tok;
-	bitstr_t		*mask;
-	u_int			 ncs, i, j, column;
-	u_int			 widths[STYLE_ALIGN_ABSOLUTE_CENTRE + 1];
-	u_int			 start[STYLE_ALIGN_ABSOLUTE_CENTRE + 1];
-	u_int			 src[STYLE_ALIGN_ABSOLUTE_CENTRE + 1];
-	u_int			 vis[STYLE_ALIGN_ABSOLUTE_CENTRE + 1];
-	u_int			 wl, wc, wr, wa;
+	struct fuzzy_pattern	*fp;
 	const char		*cp, *sp;
-	int			 bestscore = 0, groupscore, found = 0, fold;
 
-	if (width == 0)
-		return (NULL);
+	fp = xcalloc(1, sizeof *fp);
 
 	/* An empty query matches everything, with nothing highlighted. */
 	for (cp = pattern; *cp == ' ' || *cp == '|'; cp++)
 		/* nothing */;
 	if (*cp == '\0') {
-		if (score != NULL)
-			*score = 0;
-		return (bit_alloc(width));
+		fp->empty = 1;
+		return (fp);
 	}
 
 	/* Smart-case: fold unless the pattern has an uppercase character. */
-	fold = 1;
-	for (cp = pattern; *cp != '\0'; cp++) {
-		if (*cp >= 'A' && *cp <= 'Z') {
-			fold = 0;
-			break;
-		}
-	}
-
-	/* Scan the text into visible characters. */
-	cs = fuzzy_scan(text, &ncs, widths);
-	matched = xcalloc(ncs == 0 ? 1 : ncs, sizeof *matched);
-	best = xcalloc(ncs == 0 ? 1 : ncs, sizeof *best);
-	tok = xreallocarray(NULL, strlen(pattern) + 1, sizeof *tok);
+	fp->fold = !fuzzy_has_upper(pattern);
 
-	/* Match each |-separated group and keep the best-scoring one. */
+	/* Split into |-separated groups. */
 	cp = pattern;
 	while (*cp != '\0') {
 		while (*cp == ' ' || *cp == '|')
@@ -579,29 +603,127 @@ fuzzy_match(const char *pattern, const char *text, u_int width, u_int *score)
 		sp = cp;
 		while (*cp != '\0' && *cp != '|')
 			cp++;
-		memset(matched, 0, ncs == 0 ? 1 : ncs);
-		groupmatched = matched;
-		if (fuzzy_match_group(sp, cp, tok, cs, ncs, fold,
-		    &groupscore, groupmatched)) {
-			if (!found || groupscore > bestscore) {
-				found = 1;
-				bestscore = groupscore;
-				memcpy(best, matched, ncs == 0 ? 1 : ncs);
-			}
-		}
+		fp->groups = xreallocarray(fp->groups, fp->ngroups + 1,
+		    sizeof *fp->groups);
+		fuzzy_parse_group(sp, cp, &fp->groups[fp->ngroups++]);
 	}
-	free(tok);
-	if (!found) {
-		free(best);
-		free(matched);
-		free(cs);
-		return (NULL);
+	return (fp);
+}
+
+/* Free a compiled pattern. */
+void
+fuzzy_pattern_free(struct fuzzy_pattern *fp)
+{
+	struct fuzzy_group	*fg;
+	u_int			 i, j;
+
+	if (fp == NULL)
+		return;
+	for (i = 0; i < fp->ngroups; i++) {
+		fg = &fp->groups[i];
+		for (j = 0; j < fg->nterms; j++)
+			free(fg->terms[j].tok);
+		free(fg->terms);
+	}
+	free(fp->groups);
+	free(fp);
+}
+
+/*
+ * Work out if every text matched by pattern is also matched by a previous
+ * pattern, so a caller may match only the texts the previous pattern matched.
+ * This is true when the new pattern only adds characters to the end of the
+ * last term or adds more terms to the last group.
+ */
+int
+fuzzy_pattern_narrows(const char *previous, const char *pattern)
+{
+	size_t			 len = strlen(previous);
+	const char		*cp, *last, *group;
+	struct fuzzy_term	 term;
+	int			 valid;
+
+	if (strncmp(previous, pattern, len) != 0)
+		return (0);
+	if (strchr(pattern + len, '|') != NULL)
+		return (0);
+
+	/*
+	 * The first uppercase character makes every term case-sensitive, so an
+	 * inverse term may exclude less than before.
+	 */
+	if (fuzzy_has_upper(pattern + len) && !fuzzy_has_upper(previous))
+		return (0);
+
+	/* The last group must not be empty unless the whole pattern is. */
+	group = strrchr(previous, '|');
+	if (group != NULL) {
+		for (cp = group + 1; *cp == ' '; cp++)
+			/* nothing */;
+		if (*cp == '\0')
+			return (0);
 	}
 
 	/*
-	 * Work out the trimmed widths and start columns of each alignment,
-	 * mirroring format_draw_none.
+	 * If the previous pattern ended in a space, any new characters are a
+	 * new term and can only remove matches.
 	 */
+	if (len == 0 || previous[len - 1] == ' ')
+		return (1);
+
+	/*
+	 * Otherwise the last term must be valid, because an invalid term
+	 * matches nothing, and must not be inverse or anchored to the end,
+	 * because extending these may match more.
+	 */
+	last = previous + len;
+	while (last != previous && last[-1] != ' ' && last[-1] != '|')
+		last--;
+	valid = fuzzy_parse_term(last, previous + len, &term);
+	free(term.tok);
+	if (!valid || term.inverse || term.suffix)
+		return (0);
+	return (1);
+}
+
+/*
+ * Scan text so it can be matched against many patterns without decoding it
+ * again.
+ */
+struct fuzzy_text *
+fuzzy_text_create(const char *text)
+{
+	struct fuzzy_text	*ft;
+
+	ft = xcalloc(1, sizeof *ft);
+	ft->cs = fuzzy_scan(text, &ft->ncs, ft->widths);
+	return (ft);
+}
+
+/* Free a scanned text. */
+void
+fuzzy_text_free(struct fuzzy_text *ft)
+{
+	if (ft == NULL)
+		return;
+	free(ft->cs);
+	free(ft);
+}
+
+/*
+ * Build the mask of display columns occupied by the matched characters,
+ * mirroring format_draw_none to work out where each alignment is drawn.
+ */
+static bitstr_t *
+fuzzy_mask(const struct fuzzy_text *ft, const char *best, u_int width)
+{
+	const u_int	*widths = ft->widths;
+	u_int		 start[STYLE_ALIGN_ABSOLUTE_CENTRE + 1];
+	u_int		 src[STYLE_ALIGN_ABSOLUTE_CENTRE + 1];
+	u_int		 vis[STYLE_ALIGN_ABSOLUTE_CENTRE + 1];
+	u_int		 wl, wc, wr, wa, i, j, column;
+	bitstr_t	*mask;
+
 	wl = widths[STYLE_ALIGN_LEFT];
 	wc = widths[STYLE_ALIGN_CENTRE];
 	wr = widths[STYLE_ALIGN_RIGHT];
@@ -636,20 +758,95 @@ fuzzy_match(const char *pattern, const char *text, u_int width, u_int *score)
 
 	/* Set a bit for each column of each matched character. */
 	mask = bit_alloc(width);
-	for (i = 0; i < ncs; i++) {
+	for (i = 0; i < ft->ncs; i++) {
 		if (!best[i])
 			continue;
-		if (fuzzy_column(&cs[i], start, src, vis, &column) != 0)
+		if (fuzzy_column(&ft->cs[i], start, src, vis, &column) != 0)
 			continue;
-		for (j = 0; j < cs[i].width && column + j < width; j++)
+		for (j = 0; j < ft->cs[i].width && column + j < width; j++)
 			bit_set(mask, column + j);
 	}
+	return (mask);
+}
 
+/*
+ * Match a compiled pattern against a scanned text, which is drawn into a
+ * region of the given display width. Returns a bitstr_t of width bits with a
+ * bit set for each column occupied by a matched character, or NULL if there is
+ * no match. A higher returned score is better.
+ */
+bitstr_t *
+fuzzy_match_text(const struct fuzzy_pattern *fp, const struct fuzzy_text *ft,
+    u_int width, u_int *score)
+{
+	char		*matched, *best;
+	bitstr_t	*mask;
+	u_int		 i, size;
+	int		 bestscore = 0, groupscore, found = 0;
+
+	if (width == 0)
+		return (NULL);
+	if (fp->empty) {
+		if (score != NULL)
+			*score = 0;
+		return (bit_alloc(width));
+	}
+
+	size = (ft->ncs == 0) ? 1 : ft->ncs;
+	matched = xcalloc(size, sizeof *matched);
+	best = xcalloc(size, sizeof *best);
+
+	/* Match each |-separated group and keep the best-scoring one. */
+	for (i = 0; i < fp->ngroups; i++) {
+		memset(matched, 0, size);
+		if (!fuzzy_match_group(&fp->groups[i], ft->cs, ft->ncs,
+		    fp->fold, &groupscore, matched))
+			continue;
+		if (!found || groupscore > bestscore) {
+			found = 1;
+			bestscore = groupscore;
+			memcpy(best, matched, size);
+		}
+	}
+	if (!found) {
+		free(best);
+		free(matched);
+		return (NULL);
+	}
+	mask = fuzzy_mask(ft, best, width);
 	free(best);
 	free(matched);
-	free(cs);
 
 	if (score != NULL)
 		*score = (bestscore < 0) ? 0 : (u_int)bestscore;
 	return (mask);
 }
+
+/*
+ * Fuzzy match pattern against text, which is drawn into a region of the given
+ * display width. Returns a bitstr_t of width bits with a bit set for each
+ * column occupied by a matched character, or NULL if there is no match. A
+ * higher returned score is better.
+ */
+bitstr_t *
+fuzzy_match(const char *pattern, const char *text, u_int width, u_int *score)
+{
+	struct fuzzy_pattern	*fp;
+	struct fuzzy_text	*ft;
+	bitstr_t		*mask;
+
+	if (width == 0)
+		return (NULL);
+	fp = fuzzy_pattern_create(pattern);
+	if (fp->empty) {
+		fuzzy_pattern_free(fp);
+		if (score != NULL)
+			*score = 0;
+		return (bit_alloc(width));
+	}
+	ft = fuzzy_text_create(text);
+	mask = fuzzy_match_text(fp, ft, width, score);
+	fuzzy_text_free(ft);
+	fuzzy_pattern_free(fp);
+	return (mask);
+}
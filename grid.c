@@ -38,6 +38,9 @@
  * functions which work on the screen data.
  */
 
+/* Lines of history reflowed with the screen, the rest are reflowed later. */
+#define GRID_REFLOW_MARGIN 1000
+
 /* Default grid cell data. */
 const struct grid_cell grid_default_cell = {
 	{ { ' ' }, 0, 1, 1 }, 0, 0, 8, 8, 8, 0
@@ -439,6 +442,11 @@ grid_trim_history(struct grid *gd, u_int ny)
 	memmove(&gd->linedata[0], &gd->linedata[ny],
 	    remaining * (sizeof *gd->linedata));
 	memset(&gd->linedata[remaining], 0, ny * (sizeof *gd->linedata));
+
+	if (gd->reflow_lines > ny)
+		gd->reflow_lines -= ny;
+	else
+		gd->reflow_lines = 0;
 }
 
 /*
@@ -487,6 +495,8 @@ grid_remove_history(struct grid *gd, u_int ny)
 		grid_free_line(gd, start + yy);
 	memset(&gd->linedata[start], 0, ny * sizeof *gd->linedata);
 	gd->hsize -= ny;
+	if (gd->reflow_lines > gd->hsize)
+		gd->reflow_lines = gd->hsize;
 }
 
 /*
@@ -1350,7 +1360,7 @@ grid_reflow_move(struct grid *gd, struct grid_line *from)
 /* Join line below onto this one. */
 static void
 grid_reflow_join(struct grid *target, struct grid *gd, u_int sx, u_int yy,
-    u_int width, int already)
+    u_int base, u_int end, u_int width, int already)
 {
 	struct grid_line	*gl, *from = NULL;
 	struct grid_cell	 gc;
@@ -1379,7 +1389,7 @@ grid_reflow_join(struct grid *target, struct grid *gd, u_int sx, u_int yy,
 		 * If this is now the last line, there is nothing more to be
 		 * done.
 		 */
-		if (yy + 1 + lines == gd->hsize + gd->sy)
+		if (yy + 1 + lines == end)
 			break;
 		line = yy + 1 + lines;
 
@@ -1449,6 +1459,7 @@ grid_reflow_join(struct grid *target, struct grid *gd, u_int sx, u_int yy,
 	}
 
 	/* Adjust scroll position. */
+	to += base;
 	if (gd->hscrolled > to + lines)
 		gd->hscrolled -= lines;
 	else if (gd->hscrolled > to)
@@ -1458,7 +1469,7 @@ grid_reflow_join(struct grid *target, struct grid *gd, u_int sx, u_int yy,
 /* Split this line into several new ones */
 static void
 grid_reflow_split(struct grid *target, struct grid *gd, u_int sx, u_int yy,
-    u_int at)
+    u_int base, u_int end, u_int at)
 {
 	struct grid_line	*gl = &gd->linedata[yy], *first;
 	struct grid_cell	 gc;
@@ -1520,28 +1531,22 @@ grid_reflow_split(struct grid *target, struct grid *gd, u_int sx, u_int yy,
 	 * in the last new line, try to join with the next lines.
 	 */
 	if (width < sx && (flags & GRID_LINE_WRAPPED))
-		grid_reflow_join(target, gd, sx, yy, width, 1);
+		grid_reflow_join(target, gd, sx, yy, base, end, width, 1);
 }
 
-/* Reflow lines on grid to new width. */
-void
-grid_reflow(struct grid *gd, u_int sx)
+/* Reflow lines from py to py + ny - 1 into the target grid. */
+static void
+grid_reflow_lines(struct grid *target, struct grid *gd, u_int sx, u_int py,
+    u_int ny)
 {
-	struct grid		*target;
 	struct grid_line	*gl;
 	struct grid_cell	 gc;
-	u_int			 yy, width, i, at;
-
-	/*
-	 * Create a destination grid. This is just used as a container for the
-	 * line data and may not be fully valid.
-	 */
-	target = grid_create(gd->sx, 0, 0);
+	u_int			 yy, width, i, at, end = py + ny;
 
 	/*
 	 * Loop over each source line.
 	 */
-	for (yy = 0; yy < gd->hsize + gd->sy; yy++) {
+	for (yy = py; yy < end; yy++) {
 		gl = &gd->linedata[yy];
 		if (gl->flags & GRID_LINE_DEAD)
 			continue;
@@ -1581,7 +1586,7 @@ grid_reflow(struct grid *gd, u_int sx)
 		 * it was previously wrapped.
 		 */
 		if (width > sx) {
-			grid_reflow_split(target, gd, sx, yy, at);
+			grid_reflow_split(target, gd, sx, yy, py, end, at);
 			continue;
 		}
 
@@ -1590,25 +1595,103 @@ grid_reflow(struct grid *gd, u_int sx)
 		 * of the next line.
 		 */
 		if (gl->flags & GRID_LINE_WRAPPED)
-			grid_reflow_join(target, gd, sx, yy, width, 0);
+			grid_reflow_join(target, gd, sx, yy, py, end, width, 0);
 		else
 			grid_reflow_move(target, gl);
 	}
+}
 
-	/*
-	 * Replace the old grid with the new.
-	 */
-	if (target->sy < gd->sy)
-		grid_reflow_add(target, gd->sy - target->sy);
-	gd->hsize = target->sy - gd->sy;
+/* Replace lines from py to py + ny - 1 with the lines in the target grid. */
+static void
+grid_reflow_replace(struct grid *gd, struct grid *target, u_int py, u_int ny)
+{
+	u_int	total = gd->hsize + gd->sy, after = total - py - ny;
+	u_int	new_total = py + target->sy + after;
+
+	if (new_total > total) {
+		gd->linedata = xreallocarray(gd->linedata, new_total,
+		    sizeof *gd->linedata);
+	}
+	memmove(&gd->linedata[py + target->sy], &gd->linedata[py + ny],
+	    after * sizeof *gd->linedata);
+	if (target->sy != 0) {
+		memcpy(&gd->linedata[py], target->linedata,
+		    target->sy * sizeof *gd->linedata);
+	}
+	if (new_total < total) {
+		gd->linedata = xreallocarray(gd->linedata, new_total,
+		    sizeof *gd->linedata);
+	}
+	gd->hsize = new_total - gd->sy;
 	if (gd->hscrolled > gd->hsize)
 		gd->hscrolled = gd->hsize;
-	free(gd->linedata);
-	gd->linedata = target->linedata;
+
+	free(target->linedata);
 	free(target);
 	gd->scroll_generation++;
 }
 
+/* Find the start of the unwrapped line containing a line. */
+static u_int
+grid_reflow_line_start(struct grid *gd, u_int py)
+{
+	while (py > 0 && (gd->linedata[py - 1].flags & GRID_LINE_WRAPPED))
+		py--;
+	return (py);
+}
+
+/*
+ * Reflow lines on grid to new width. Only the screen and the last
+ * GRID_REFLOW_MARGIN lines of history are reflowed now, the rest is left for
+ * grid_reflow_history. Lines are only ever joined or split within an unwrapped
+ * line, so the two parts can be reflowed separately.
+ */
+void
+grid_reflow(struct grid *gd, u_int sx)
+{
+	struct grid	*target;
+	u_int		 py = 0, total = gd->hsize + gd->sy;
+
+	if (gd->hsize > GRID_REFLOW_MARGIN)
+		py = grid_reflow_line_start(gd, gd->hsize - GRID_REFLOW_MARGIN);
+
+	/*
+	 * Create a destination grid. This is just used as a container for the
+	 * line data and may not be fully valid.
+	 */
+	target = grid_create(gd->sx, 0, 0);
+	grid_reflow_lines(target, gd, sx, py, total - py);
+	if (py + target->sy < gd->sy)
+		grid_reflow_add(target, gd->sy - py - target->sy);
+	grid_reflow_replace(gd, target, py, total - py);
+	gd->reflow_lines = py;
+	if (py != 0)
+		log_debug("%s: %u lines left to reflow", __func__, py);
+}
+
+/*
+ * Reflow the last ny lines (or all if ny is zero) of the history left by
+ * grid_reflow to the current width. Returns the number of lines still to be
+ * reflowed.
+ */
+u_int
+grid_reflow_history(struct grid *gd, u_int ny)
+{
+	struct grid	*target;
+	u_int		 py = 0, end = gd->reflow_lines;
+
+	if (end == 0)
+		return (0);
+	if (ny != 0 && ny < end)
+		py = grid_reflow_line_start(gd, end - ny);
+
+	target = grid_create(gd->sx, 0, 0);
+	grid_reflow_lines(target, gd, gd->sx, py, end - py);
+	grid_reflow_replace(gd, target, py, end - py);
+	gd->reflow_lines = py;
+	return (py);
+}
+
 /* Convert to position based on wrapped lines. */
 void
 grid_wrap_position(struct grid *gd, u_int px, u_int py, u_int *wx, u_int *wy)
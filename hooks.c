@@ -47,10 +47,14 @@ struct hooks_data {
 	int			 expand;
 };
 
-/* Hook event sink registered for a notify event name. */
+/*
+ * Hook event sink registered for a notify event name. The sink for a built-in
+ * hook is only active while the hook has commands in some options.
+ */
 struct hooks_event {
 	char			*name;
 	struct events_sink	*sink;
+	u_int			 commands;
 	TAILQ_ENTRY(hooks_event) entry;
 };
 TAILQ_HEAD(hooks_events, hooks_event);
@@ -248,21 +252,55 @@ hooks_event_cb(const char *name, struct event_payload *ep,
 		hooks_insert_event(NULL, name, ep, NULL, 0);
 }
 
-/* Add a hook event sink. */
-void
-hooks_add_event(const char *name)
+/* Find a hook event, optionally creating it. */
+static struct hooks_event *
+hooks_find_event(const char *name, int create)
 {
 	struct hooks_event	*he;
 
 	TAILQ_FOREACH(he, &hooks_events, entry) {
 		if (strcmp(he->name, name) == 0)
-			return;
+			return (he);
 	}
+	if (!create)
+		return (NULL);
 
 	he = xcalloc(1, sizeof *he);
 	he->name = xstrdup(name);
-	he->sink = events_add_sink(name, hooks_event_cb, NULL);
 	TAILQ_INSERT_TAIL(&hooks_events, he, entry);
+	return (he);
+}
+
+/* Add a hook event sink. */
+void
+hooks_add_event(const char *name)
+{
+	struct hooks_event			*he;
+	const struct options_table_entry	*oe;
+
+	he = hooks_find_event(name, 1);
+	if (he->sink != NULL)
+		return;
+	he->sink = events_add_sink(name, hooks_event_cb, NULL);
+
+	oe = options_search(name);
+	if (oe != NULL && (oe->flags & OPTIONS_TABLE_IS_HOOK))
+		events_set_sink_active(he->sink, he->commands != 0);
+}
+
+/* Count a command added to or removed from a built-in hook. */
+void
+hooks_count_command(const char *name, int add)
+{
+	struct hooks_event	*he;
+
+	he = hooks_find_event(name, 1);
+	if (add)
+		he->commands++;
+	else if (he->commands != 0)
+		he->commands--;
+	if (he->sink != NULL)
+		events_set_sink_active(he->sink, he->commands != 0);
 }
 
 /* Return if a hook event sink exists. */
@@ -271,11 +309,8 @@ hooks_is_event(const char *name)
 {
 	struct hooks_event	*he;
 
-	TAILQ_FOREACH(he, &hooks_events, entry) {
-		if (strcmp(he->name, name) == 0)
-			return (1);
-	}
-	return (0);
+	he = hooks_find_event(name, 0);
+	return (he != NULL && he->sink != NULL);
 }
 
 /* Return if an event name can be fired through the hooks path. */
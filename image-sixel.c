@@ -26,11 +26,6 @@
 #define SIXEL_WIDTH_LIMIT 10000
 #define SIXEL_HEIGHT_LIMIT 10000
 
-struct sixel_line {
-	u_int		 x;
-	uint16_t	*data;
-};
-
 struct sixel_image {
 	u_int			 x;
 	u_int			 y;
@@ -50,7 +45,9 @@ struct sixel_image {
 	u_int			 dy;
 	u_int			 dc;
 
-	struct sixel_line	*lines;
+	/* Colour indexes of either one or two bytes per pixel. */
+	u_char			*plane;
+	u_int			 depth;
 };
 
 struct sixel_chunk {
@@ -66,70 +63,204 @@ struct sixel_chunk {
 	char	*data;
 };
 
-static int
-sixel_parse_expand_lines(struct sixel_image *si, u_int y)
+static u_int
+sixel_get_pixel(struct sixel_image *si, u_int x, u_int y)
 {
-	if (y <= si->y)
+	size_t	off;
+
+	if (y >= si->y || x >= si->x)
 		return (0);
-	if (y > SIXEL_HEIGHT_LIMIT)
-		return (1);
-	si->lines = xrecallocarray(si->lines, si->y, y, sizeof *si->lines);
-	si->y = y;
-	return (0);
+	off = (size_t)y * si->x + x;
+	if (si->depth == 1)
+		return (si->plane[off]);
+	return (((uint16_t *)si->plane)[off]);
 }
 
-static int
-sixel_parse_expand_line(struct sixel_image *si, struct sixel_line *sl, u_int x)
+static void
+sixel_set_pixel(struct sixel_image *si, u_int x, u_int y, u_int c)
 {
-	if (x <= sl->x)
-		return (0);
-	if (x > SIXEL_WIDTH_LIMIT)
-		return (1);
-	if (x > si->x)
-		si->x = x;
-	sl->data = xrecallocarray(sl->data, sl->x, si->x, sizeof *sl->data);
-	sl->x = si->x;
-	return (0);
+	size_t	off;
+
+	off = (size_t)y * si->x + x;
+	if (si->depth == 1)
+		si->plane[off] = c;
+	else
+		((uint16_t *)si->plane)[off] = c;
+}
+
+/* Allocate the plane for an image of the given size and colours. */
+static void
+sixel_alloc(struct sixel_image *si, u_int x, u_int y, u_int colours)
+{
+	si->x = x;
+	si->y = y;
+	if (colours < 256)
+		si->depth = 1;
+	else
+		si->depth = 2;
+	if (x != 0 && y != 0)
+		si->plane = xcalloc(y, (size_t)x * si->depth);
 }
 
+/* Read a number for the size scan, stopping at the width limit. */
 static u_int
-sixel_get_pixel(struct sixel_image *si, u_int x, u_int y)
+sixel_size_number(const char **cp, const char *end)
 {
-	struct sixel_line	*sl;
+	u_int	n = 0;
 
-	if (y >= si->y)
-		return (0);
-	sl = &si->lines[y];
-	if (x >= sl->x)
-		return (0);
-	return (sl->data[x]);
+	while (*cp != end && **cp >= '0' && **cp <= '9') {
+		if (n <= SIXEL_WIDTH_LIMIT)
+			n = (n * 10) + (**cp - '0');
+		(*cp)++;
+	}
+	return (n);
 }
 
+/*
+ * Scan the image to find its size and the number of colours so that the plane
+ * can be allocated once before parsing. Errors are left for the parser to
+ * find.
+ */
 static int
-sixel_set_pixel(struct sixel_image *si, u_int x, u_int y, u_int c)
+sixel_parse_size(const char *cp, const char *end, u_int *x, u_int *y,
+    u_int *colours)
 {
-	struct sixel_line	*sl;
-
-	if (sixel_parse_expand_lines(si, y + 1) != 0)
-		return (1);
-	sl = &si->lines[y];
-	if (sixel_parse_expand_line(si, sl, x + 1) != 0)
-		return (1);
-	sl->data[x] = c;
+	u_int	dx = 0, dy = 0, n, i, v[4], nv, bits = 0;
+	u_char	ch;
+
+	*x = *y = *colours = 0;
+	while (cp != end) {
+		ch = *cp++;
+
+		/* Most of an image is sixel characters so check them first. */
+		n = 1;
+		if (ch >= 0x3f) {
+			if (ch > 0x7e)
+				continue;
+		} else if (ch == '!') {
+			n = sixel_size_number(&cp, end);
+			if (cp == end)
+				break;
+			ch = *cp++;
+			if (ch < 0x3f || ch > 0x7e)
+				continue;
+		} else {
+			/* Apply the sixels seen on this line so far. */
+			if (bits != 0) {
+				for (i = 5; (~bits & (1 << i)); i--)
+					/* nothing */;
+				if (dy + i + 1 > *y)
+					*y = dy + i + 1;
+				bits = 0;
+			}
+
+			switch (ch) {
+			case '"':
+				nv = 0;
+				for (;;) {
+					v[nv++] = sixel_size_number(&cp, end);
+					if (nv == nitems(v) ||
+					    cp == end ||
+					    *cp != ';')
+						break;
+					cp++;
+				}
+				if (nv == nitems(v)) {
+					if (v[2] > SIXEL_WIDTH_LIMIT)
+						goto too_wide;
+					if (v[3] > SIXEL_HEIGHT_LIMIT)
+						goto too_tall;
+					if (v[2] > *x)
+						*x = v[2];
+					if (v[3] > *y)
+						*y = v[3];
+				}
+				break;
+			case '#':
+				n = sixel_size_number(&cp, end);
+				if (n <= SIXEL_COLOUR_REGISTERS &&
+				    n + 1 > *colours)
+					*colours = n + 1;
+				break;
+			case '-':
+				dx = 0;
+				dy += 6;
+				break;
+			case '$':
+				dx = 0;
+				break;
+			}
+			while (cp != end &&
+			    (*cp == ';' || (*cp >= '0' && *cp <= '9')))
+				cp++;
+			continue;
+		}
+
+		ch -= 0x3f;
+		if (dx + n > SIXEL_WIDTH_LIMIT)
+			dx = SIXEL_WIDTH_LIMIT + 1;
+		else
+			dx += n;
+		if (ch != 0) {
+			bits |= ch;
+			if (dx > *x) {
+				*x = dx;
+				if (*x > SIXEL_WIDTH_LIMIT)
+					goto too_wide;
+			}
+		}
+	}
+	if (bits != 0) {
+		for (i = 5; (~bits & (1 << i)); i--)
+			/* nothing */;
+		if (dy + i + 1 > *y)
+			*y = dy + i + 1;
+	}
+	if (*y > SIXEL_HEIGHT_LIMIT)
+		goto too_tall;
 	return (0);
+
+too_wide:
+	log_debug("%s: image is too wide", __func__);
+	return (-1);
+
+too_tall:
+	log_debug("%s: image is too tall", __func__);
+	return (-1);
 }
 
+/* Write a sixel repeated a number of times, filling each row as a run. */
 static int
-sixel_parse_write(struct sixel_image *si, u_int ch)
+sixel_parse_write(struct sixel_image *si, u_int ch, u_int n)
 {
-	u_int			 i;
+	uint16_t	*data;
+	size_t		 off;
+	u_int		 i, x;
 
-	for (i = 0; i < 6; i++) {
-		if (ch & (1 << i)) {
-			if (sixel_set_pixel(si, si->dx, si->dy + i, si->dc))
-				return (1);
+	if (si->dx >= si->x || n > si->x - si->dx) {
+		if (ch != 0)
+			return (1);
+		si->dx = si->x;
+		return (0);
+	}
+	off = (size_t)si->dy * si->x + si->dx;
+	for (i = 0; ch != 0; i++, ch >>= 1, off += si->x) {
+		if (~ch & 1)
+			continue;
+		if (si->dy + i >= si->y)
+			return (1);
+		if (si->depth == 1) {
+			if (n == 1)
+				si->plane[off] = si->dc;
+			else
+				memset(si->plane + off, si->dc, n);
+		} else {
+			data = (uint16_t *)si->plane + off;
+			for (x = 0; x < n; x++)
+				data[x] = si->dc;
 		}
 	}
+	si->dx += n;
 	return (0);
 }
 
@@ -176,9 +307,6 @@ sixel_parse_attributes(struct sixel_image *si, const char *cp, const char *end)
 		return (NULL);
 	}
 
-	si->x = x;
-	sixel_parse_expand_lines(si, y);
-
 	si->set_ra = 1;
 	si->ra_x = x;
 	si->ra_y = y;
@@ -254,7 +382,7 @@ sixel_parse_repeat(struct sixel_image *si, const char *cp, const char *end)
 {
 	const char	*last;
 	char		 tmp[32], ch;
-	u_int		 n = 0, i;
+	u_int		 n = 0;
 	const char	*errstr = NULL;
 
 	last = cp;
@@ -279,13 +407,14 @@ sixel_parse_repeat(struct sixel_image *si, const char *cp, const char *end)
 		return (NULL);
 	}
 
-	ch = (*last++) - 0x3f;
-	for (i = 0; i < n; i++) {
-		if (sixel_parse_write(si, ch) != 0) {
-			log_debug("%s: width limit reached", __func__);
-			return (NULL);
-		}
-		si->dx++;
+	ch = *last++;
+	if (ch < 0x3f || ch > 0x7e) {
+		log_debug("%s: invalid repeat character", __func__);
+		return (NULL);
+	}
+	if (sixel_parse_write(si, ch - 0x3f, n) != 0) {
+		log_debug("%s: width limit reached", __func__);
+		return (NULL);
 	}
 	return (last);
 }
@@ -296,16 +425,24 @@ sixel_parse(const char *buf, size_t len, u_int p2, u_int xpixel, u_int ypixel)
 	struct sixel_image	*si;
 	const char		*cp = buf, *end = buf + len;
 	char			 ch;
+	u_int			 x, y, colours;
 
 	if (len == 0 || len == 1 || *cp++ != 'q') {
 		log_debug("%s: empty image", __func__);
 		return (NULL);
 	}
+	if (sixel_parse_size(cp, end, &x, &y, &colours) != 0)
+		return (NULL);
+	if (x == 0 || y == 0) {
+		log_debug("%s: empty image", __func__);
+		return (NULL);
+	}
 
 	si = xcalloc (1, sizeof *si);
 	si->xpixel = xpixel;
 	si->ypixel = ypixel;
 	si->p2 = p2;
+	sixel_alloc(si, x, y, colours);
 
 	while (cp != end) {
 		ch = *cp++;
@@ -337,17 +474,13 @@ sixel_parse(const char *buf, size_t len, u_int p2, u_int xpixel, u_int ypixel)
 				break;
 			if (ch < 0x3f || ch > 0x7e)
 				goto bad;
-			if (sixel_parse_write(si, ch - 0x3f) != 0) {
+			if (sixel_parse_write(si, ch - 0x3f, 1) != 0) {
 				log_debug("%s: width limit reached", __func__);
 				goto bad;
 			}
-			si->dx++;
 			break;
 		}
 	}
-
-	if (si->x == 0 || si->y == 0)
-		goto bad;
 	return (si);
 
 bad:
@@ -358,34 +491,35 @@ bad:
 void
 sixel_free(struct sixel_image *si)
 {
-	u_int	y;
-
-	for (y = 0; y < si->y; y++)
-		free(si->lines[y].data);
-	free(si->lines);
+	free(si->plane);
 
 	free(si->colours);
 	free(si);
 }
 
+/* Get the memory used by an image. */
+size_t
+sixel_size(struct sixel_image *si)
+{
+	return (sizeof *si + si->ncolours * sizeof *si->colours +
+	    (size_t)si->x * si->y * si->depth);
+}
+
 void
 sixel_log(struct sixel_image *si)
 {
-	struct sixel_line	*sl;
 	char			 s[SIXEL_WIDTH_LIMIT + 1];
-	u_int			 i, x, y, cx, cy;
+	u_int			 i, x, y, cx, cy, c;
 
 	sixel_size_in_cells(si, &cx, &cy);
 	log_debug("%s: image %ux%u (%ux%u)", __func__, si->x, si->y, cx, cy);
 	for (i = 0; i < si->ncolours; i++)
 		log_debug("%s: colour %u is %07x", __func__, i, si->colours[i]);
 	for (y = 0; y < si->y; y++) {
-		sl = &si->lines[y];
 		for (x = 0; x < si->x; x++) {
-			if (x >= sl->x)
-				s[x] = '_';
-			else if (sl->data[x] != 0)
-				s[x] = '0' + (sl->data[x] - 1) % 10;
+			c = sixel_get_pixel(si, x, y);
+			if (c != 0)
+				s[x] = '0' + (c - 1) % 10;
 			else
 				s[x] = '.';
 			}
@@ -460,6 +594,7 @@ sixel_scale(struct sixel_image *si, u_int xpixel, u_int ypixel, u_int ox,
 	new->ra_y = new->ra_y * ypixel / si->ypixel;
 
 	new->used_colours = si->used_colours;
+	sixel_alloc(new, tsx, tsy, si->used_colours);
 	for (y = 0; y < tsy; y++) {
 		py = poy + ((double)y * psy / tsy);
 		for (x = 0; x < tsx; x++) {
@@ -516,18 +651,13 @@ sixel_print_compress_colors(struct sixel_image *si, struct sixel_chunk *chunks,
 {
 	u_int			 i, x, c, dx, colors[6];
 	struct sixel_chunk	*chunk = NULL;
-	struct sixel_line	*sl;
 
 	for (x = 0; x < si->x; x++) {
 		for (i = 0; i < 6; i++) {
-			colors[i] = 0;
-			if (y + i < si->y) {
-				sl = &si->lines[y + i];
-				if (x < sl->x && sl->data[x] != 0) {
-					colors[i] = sl->data[x];
-					c = sl->data[x] - 1;
-					chunks[c].next_pattern |= 1 << i;
-				}
+			colors[i] = sixel_get_pixel(si, x, y + i);
+			if (colors[i] != 0) {
+				c = colors[i] - 1;
+				chunks[c].next_pattern |= 1 << i;
 			}
 		}
 
@@ -23,9 +23,28 @@
 
 #include "tmux.h"
 
+/*
+ * All images are kept in least recently used order. When the total size goes
+ * over the image-memory-limit option, the largest of the few least recently
+ * used images is freed, so one big image goes before several small ones.
+ */
 static struct images	all_images = TAILQ_HEAD_INITIALIZER(all_images);
 static u_int		all_images_count;
-#define MAX_IMAGE_COUNT 20
+static size_t		all_images_size;
+#define IMAGE_EVICT_CANDIDATES 4
+
+/*
+ * Encoded images are shared by all clients with the same cell size. They are
+ * kept in least recently used order and discarded once the total size is over
+ * the limit.
+ */
+static struct image_encoded_list all_encoded =
+    TAILQ_HEAD_INITIALIZER(all_encoded);
+static u_int		all_encoded_count;
+static size_t		all_encoded_size;
+static u_int		image_cache_hits;
+static u_int		image_cache_misses;
+#define MAX_ENCODED_SIZE (16 * 1024 * 1024)
 
 static void printflike(3, 4)
 image_log(struct image *im, const char* from, const char* fmt, ...)
@@ -50,6 +69,32 @@ image_log(struct image *im, const char* from, const char* fmt, ...)
 	    im->px, im->py, s);
 }
 
+static void
+image_free_encoded(struct image_encoded *ie)
+{
+	struct image	*im = ie->im;
+
+	image_log(im, __func__, "%ux%u %u,%u %ux%u (%zu bytes)", ie->xpixel,
+	    ie->ypixel, ie->ox, ie->oy, ie->sx, ie->sy, ie->size);
+
+	TAILQ_REMOVE(&all_encoded, ie, all_entry);
+	all_encoded_count--;
+	all_encoded_size -= ie->size;
+
+	TAILQ_REMOVE(&im->encoded, ie, entry);
+	free(ie->data);
+	free(ie);
+}
+
+static void
+image_free_all_encoded(struct image *im)
+{
+	struct image_encoded	*ie, *ie1;
+
+	TAILQ_FOREACH_SAFE(ie, &im->encoded, entry, ie1)
+		image_free_encoded(ie);
+}
+
 static void
 image_free(struct image *im)
 {
@@ -57,6 +102,9 @@ image_free(struct image *im)
 
 	TAILQ_REMOVE(&all_images, im, all_entry);
 	all_images_count--;
+	all_images_size -= im->size;
+
+	image_free_all_encoded(im);
 
 	TAILQ_REMOVE(im->list, im, entry);
 	sixel_free(im->data);
@@ -119,6 +167,53 @@ image_fallback(char **ret, u_int sx, u_int sy)
 	free(label);
 }
 
+/* Work out the memory used by an image. */
+static void
+image_set_size(struct image *im)
+{
+	all_images_size -= im->size;
+	im->size = sizeof *im + sixel_size(im->data) + strlen(im->fallback);
+	all_images_size += im->size;
+}
+
+/* Mark an image as recently used. */
+static void
+image_touch(struct image *im)
+{
+	if (TAILQ_NEXT(im, all_entry) == NULL)
+		return;
+	TAILQ_REMOVE(&all_images, im, all_entry);
+	TAILQ_INSERT_TAIL(&all_images, im, all_entry);
+}
+
+/* Free images until under the memory limit, except the one given. */
+static void
+image_evict(struct image *keep)
+{
+	struct image	*im, *victim;
+	size_t		 limit;
+	u_int		 n;
+
+	limit = options_get_number(global_options, "image-memory-limit");
+	while (all_images_size > limit) {
+		victim = NULL;
+		n = 0;
+		TAILQ_FOREACH(im, &all_images, all_entry) {
+			if (im == keep)
+				continue;
+			if (victim == NULL || im->size > victim->size)
+				victim = im;
+			if (++n == IMAGE_EVICT_CANDIDATES)
+				break;
+		}
+		if (victim == NULL)
+			break;
+		image_log(victim, __func__, "%zu bytes (total %zu, limit %zu)",
+		    victim->size, all_images_size, limit);
+		image_free(victim);
+	}
+}
+
 struct image*
 image_store(struct screen *s, struct sixel_image *si)
 {
@@ -127,6 +222,7 @@ image_store(struct screen *s, struct sixel_image *si)
 	im = xcalloc(1, sizeof *im);
 	im->s = s;
 	im->data = si;
+	TAILQ_INIT(&im->encoded);
 
 	im->px = s->cx;
 	im->py = s->cy;
@@ -139,8 +235,9 @@ image_store(struct screen *s, struct sixel_image *si)
 	TAILQ_INSERT_TAIL(im->list, im, entry);
 
 	TAILQ_INSERT_TAIL(&all_images, im, all_entry);
-	if (++all_images_count == MAX_IMAGE_COUNT)
-		image_free(TAILQ_FIRST(&all_images));
+	all_images_count++;
+	image_set_size(im);
+	image_evict(im);
 
 	return (im);
 }
@@ -208,6 +305,7 @@ image_scroll_up(struct screen *s, u_int lines)
 		image_log(im, __func__, "3, lines=%u, sy=%u", lines, sy);
 
 		new = sixel_scale(im->data, 0, 0, 0, im->sy - sy, sx, sy, 1);
+		image_free_all_encoded(im);
 		sixel_free(im->data);
 		im->data = new;
 
@@ -216,7 +314,108 @@ image_scroll_up(struct screen *s, u_int lines)
 
 		free(im->fallback);
 		image_fallback(&im->fallback, im->sx, im->sy);
+		image_set_size(im);
 		redraw = 1;
 	}
 	return (redraw);
 }
+
+/*
+ * Get the image encoded for the given cell size and area, using a cached copy
+ * if there is one. The returned data is valid until the next call.
+ */
+const char *
+image_encode(struct image *im, u_int xpixel, u_int ypixel, u_int ox, u_int oy,
+    u_int sx, u_int sy, size_t *size)
+{
+	struct image_encoded	*ie;
+	struct sixel_image	*new;
+	char			*data;
+
+	TAILQ_FOREACH(ie, &im->encoded, entry) {
+		if (ie->xpixel == xpixel &&
+		    ie->ypixel == ypixel &&
+		    ie->ox == ox &&
+		    ie->oy == oy &&
+		    ie->sx == sx &&
+		    ie->sy == sy)
+			break;
+	}
+	image_touch(im);
+
+	if (ie != NULL) {
+		image_cache_hits++;
+		TAILQ_REMOVE(&all_encoded, ie, all_entry);
+		TAILQ_INSERT_TAIL(&all_encoded, ie, all_entry);
+		*size = ie->size;
+		return (ie->data);
+	}
+	image_cache_misses++;
+
+	new = sixel_scale(im->data, xpixel, ypixel, ox, oy, sx, sy, 0);
+	if (new == NULL)
+		return (NULL);
+	data = sixel_print(new, im->data, size);
+	sixel_free(new);
+	if (data == NULL)
+		return (NULL);
+
+	ie = xcalloc(1, sizeof *ie);
+	ie->im = im;
+	ie->xpixel = xpixel;
+	ie->ypixel = ypixel;
+	ie->ox = ox;
+	ie->oy = oy;
+	ie->sx = sx;
+	ie->sy = sy;
+	ie->data = data;
+	ie->size = *size;
+	image_log(im, __func__, "%ux%u %u,%u %ux%u (%zu bytes)", xpixel,
+	    ypixel, ox, oy, sx, sy, ie->size);
+
+	TAILQ_INSERT_TAIL(&im->encoded, ie, entry);
+	TAILQ_INSERT_TAIL(&all_encoded, ie, all_entry);
+	all_encoded_count++;
+	all_encoded_size += ie->size;
+
+	/* Discard the least recently used until under the limit. */
+	while (all_encoded_size > MAX_ENCODED_SIZE &&
+	    TAILQ_FIRST(&all_encoded) != ie)
+		image_free_encoded(TAILQ_FIRST(&all_encoded));
+
+	return (ie->data);
+}
+
+/* Get encoded image cache statistics. */
+void
+image_cache_stats(u_int *hits, u_int *misses, u_int *count, size_t *size)
+{
+	*hits = image_cache_hits;
+	*misses = image_cache_misses;
+	*count = all_encoded_count;
+	*size = all_encoded_size;
+}
+
+/* Get the number and size of images on a screen, or on all screens. */
+void
+image_stats(struct screen *s, u_int *count, size_t *size)
+{
+	struct image	*im;
+
+	if (s == NULL) {
+		*count = all_images_count;
+		*size = all_images_size;
+		return;
+	}
+
+	*count = 0;
+	*size = 0;
+	TAILQ_FOREACH(im, &s->images, entry) {
+		(*count)++;
+		(*size) += im->size;
+	}
+	TAILQ_FOREACH(im, &s->saved_images, entry) {
+		(*count)++;
+		(*size) += im->size;
+	}
+}
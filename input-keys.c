@@ -402,6 +402,7 @@ input_key_pane(struct window_pane *wp, key_code key, struct mouse_event *m)
 		    key_string_lookup_key(key, 1), wp->id);
 	}
 
+	paste_flush(wp);
 	if (KEYC_IS_MOUSE(key)) {
 		if (m != NULL && m->wp != -1 && (u_int)m->wp == wp->id)
 			input_key_mouse(wp, m);
@@ -28,6 +28,24 @@
 
 #include "tmux.h"
 
+/* Options read while parsing. */
+static struct options_handle oh_allow_passthrough =
+    OPTIONS_HANDLE("allow-passthrough");
+static struct options_handle oh_allow_rename =
+    OPTIONS_HANDLE("allow-rename");
+static struct options_handle oh_allow_set_title =
+    OPTIONS_HANDLE("allow-set-title");
+static struct options_handle oh_automatic_rename =
+    OPTIONS_HANDLE("automatic-rename");
+static struct options_handle oh_cursor_style =
+    OPTIONS_HANDLE("cursor-style");
+static struct options_handle oh_extended_keys =
+    OPTIONS_HANDLE("extended-keys");
+static struct options_handle oh_get_clipboard =
+    OPTIONS_HANDLE("get-clipboard");
+static struct options_handle oh_set_clipboard =
+    OPTIONS_HANDLE("set-clipboard");
+
 /*
  * Based on the description by Paul Williams at:
  *
@@ -1533,7 +1551,8 @@ input_csi_dispatch(struct input_ctx *ictx)
 		 * Set the extended key reporting mode as per the client
 		 * request, unless "extended-keys" is set to "off".
 		 */
-		ek = options_get_number(global_options, "extended-keys");
+		ek = options_get_number_handle(global_options,
+		    &oh_extended_keys);
 		if (ek == 0)
 			break;
 		screen_write_mode_clear(sctx, EXTENDED_KEY_MODES);
@@ -1553,7 +1572,9 @@ input_csi_dispatch(struct input_ctx *ictx)
 		 */
 		screen_write_mode_clear(sctx,
 		    MODE_KEYS_EXTENDED|MODE_KEYS_EXTENDED_2);
-		if (options_get_number(global_options, "extended-keys") == 2)
+		ek = options_get_number_handle(global_options,
+		    &oh_extended_keys);
+		if (ek == 2)
 			screen_write_mode_set(sctx, MODE_KEYS_EXTENDED);
 		break;
 	case INPUT_CSI_WINOPS:
@@ -1671,7 +1692,8 @@ input_csi_dispatch(struct input_ctx *ictx)
 					oo = ictx->wp->options;
 				else
 					oo = global_w_options;
-				p = options_get_number(oo, "cursor-style");
+				p = options_get_number_handle(oo,
+				    &oh_cursor_style);
 
 				/* blink for 1,3,5; steady for 0,2,4,6 */
 				n = (p == 1 || p == 3 || p == 5) ? 1 : 2;
@@ -2594,7 +2616,7 @@ input_handle_decrqss(struct input_ctx *ictx)
 			oo = wp->options;
 		else
 			oo = global_w_options;
-		opt_ps = options_get_number(oo, "cursor-style");
+		opt_ps = options_get_number_handle(oo, &oh_cursor_style);
 
 		/* Sanity clamp: valid Ps are 0..6 per DECSCUSR. */
 		if (opt_ps < 0 || opt_ps > 6)
@@ -2669,7 +2691,8 @@ input_dcs_dispatch(struct input_ctx *ictx)
 		 */
 	}
 
-	allow_passthrough = options_get_number(oo, "allow-passthrough");
+	allow_passthrough = options_get_number_handle(oo,
+	    &oh_allow_passthrough);
 	if (!allow_passthrough)
 		return (0);
 	log_debug("%s: \"%s\"", __func__, buf);
@@ -2722,7 +2745,8 @@ input_exit_osc(struct input_ctx *ictx)
 	case 0:
 	case 2:
 		if (wp != NULL &&
-		    options_get_number(wp->options, "allow-set-title") &&
+		    options_get_number_handle(wp->options,
+		    &oh_allow_set_title) &&
 		    screen_set_title(sctx->s, p, 1)) {
 			input_fire_pane_title_changed(wp, p);
 			server_redraw_window_borders(wp->window);
@@ -2800,7 +2824,7 @@ input_exit_apc(struct input_ctx *ictx)
 	log_debug("%s: \"%s\"", __func__, ictx->input_buf);
 
 	if (wp != NULL &&
-	    options_get_number(wp->options, "allow-set-title") &&
+	    options_get_number_handle(wp->options, &oh_allow_set_title) &&
 	    screen_set_title(sctx->s, ictx->input_buf, 1)) {
 		input_fire_pane_title_changed(wp, ictx->input_buf);
 		server_redraw_window_borders(wp->window);
@@ -2831,7 +2855,7 @@ input_exit_rename(struct input_ctx *ictx)
 		return;
 	if (ictx->flags & INPUT_DISCARD)
 		return;
-	if (!options_get_number(ictx->wp->options, "allow-rename"))
+	if (!options_get_number_handle(ictx->wp->options, &oh_allow_rename))
 		return;
 	log_debug("%s: \"%s\"", __func__, ictx->input_buf);
 
@@ -2843,7 +2867,8 @@ input_exit_rename(struct input_ctx *ictx)
 		o = options_get_only(w->options, "automatic-rename");
 		if (o != NULL)
 			options_remove_or_default(o, NULL, NULL);
-		if (!options_get_number(w->options, "automatic-rename"))
+		if (!options_get_number_handle(w->options,
+		    &oh_automatic_rename))
 			window_set_name(w, "", 1);
 	} else {
 		options_set_number(w->options, "automatic-rename", 0);
@@ -3345,7 +3370,7 @@ input_osc_52_reply(struct input_ctx *ictx, char clip)
 	const char		*buf;
 	size_t			 len;
 
-	state = options_get_number(global_options, "get-clipboard");
+	state = options_get_number_handle(global_options, &oh_get_clipboard);
 	if (state == 0)
 		return;
 	if (state == 1) {
@@ -3375,7 +3400,7 @@ input_osc_52_parse(struct input_ctx *ictx, const char *p, u_char **out,
 	const char	*allow = "cpqs01234567";
 	u_int		 i, j = 0;
 
-	if (options_get_number(global_options, "set-clipboard") != 2)
+	if (options_get_number_handle(global_options, &oh_set_clipboard) != 2)
 		return (0);
 
 	if ((end = strchr(p, ';')) == NULL)
@@ -3647,7 +3672,7 @@ input_request_clipboard_reply(struct input_request *ir, void *data)
 	int					 state;
 	char					*copy;
 
-	state = options_get_number(global_options, "get-clipboard");
+	state = options_get_number_handle(global_options, &oh_get_clipboard);
 	if (state == 0 || state == 1)
 		return;
 	if (state == 3) {
@@ -19,6 +19,7 @@
 #include <sys/types.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <sys/wait.h>
 
 #include <fcntl.h>
@@ -61,12 +62,60 @@ struct job {
 	job_free_cb		 freecb;
 	void			*data;
 
+	char			*cwd;
+	struct job_worker	*worker;
+	int			 queued;
+	struct timeval		 started;
+
 	LIST_ENTRY(job)		 entry;
+	TAILQ_ENTRY(job)	 queue_entry;
 };
 
 /* All jobs list. */
 static LIST_HEAD(joblist, job) all_jobs = LIST_HEAD_INITIALIZER(all_jobs);
 
+/*
+ * A long-lived shell which runs jobs from the pool, so the server does not
+ * need to fork for each one. Each command is written to the shell's input and
+ * is followed in the output by a marker line with its exit status. The marker
+ * is random and new for each command, so the command cannot print it.
+ */
+struct job_worker {
+	pid_t			 pid;
+	int			 fd;
+	struct bufferevent	*event;
+
+	struct job		*job;
+	int			 busy;
+	u_int			 runs;
+	struct event		 timer;
+	char			 marker[64];
+
+	TAILQ_ENTRY(job_worker)	 entry;
+};
+static TAILQ_HEAD(, job_worker) job_workers =
+    TAILQ_HEAD_INITIALIZER(job_workers);
+static u_int		job_workers_count;
+
+/* Jobs waiting for a worker. */
+static TAILQ_HEAD(, job) job_queue = TAILQ_HEAD_INITIALIZER(job_queue);
+static u_int		job_queue_count;
+
+static u_int		job_pool_runs;
+static u_int		job_pool_last;
+static uint64_t		job_pool_total;
+
+/* Restart workers after this many jobs to pick up environment changes. */
+#define JOB_WORKER_MAX_RUNS 100
+
+static struct job *job_pool_run(const char *, const char *, job_update_cb,
+		    job_complete_cb, job_free_cb, void *, int);
+static void	job_worker_read_callback(struct bufferevent *, void *);
+static void	job_worker_error_callback(struct bufferevent *, short, void *);
+static void	job_worker_timer_callback(int, short, void *);
+static void	job_worker_free(struct job_worker *);
+static void	job_worker_lost(struct job_worker *, int);
+
 /* Start a job running. */
 struct job *
 job_run(const char *cmd, int argc, char **argv, struct environ *e,
@@ -84,6 +133,16 @@ job_run(const char *cmd, int argc, char **argv, struct environ *e,
 	char		**argvp, tty[TTY_NAME_MAX], *argv0;
 	struct options	 *oo;
 
+	if ((flags & JOB_POOL) &&
+	    cmd != NULL &&
+	    e == NULL &&
+	    s == NULL &&
+	    (~flags & JOB_PTY) &&
+	    options_get_number(global_options, "job-pool-size") != 0) {
+		return (job_pool_run(cmd, cwd, updatecb, completecb, freecb,
+		    data, flags));
+	}
+
 	/*
 	 * Do not set TERM during .tmux.conf (second argument here), it is nice
 	 * to be able to use if-shell to decide on default-terminal based on
@@ -207,6 +266,7 @@ job_run(const char *cmd, int argc, char **argv, struct environ *e,
 	if (flags & JOB_PTY)
 		strlcpy(job->tty, tty, sizeof job->tty);
 	job->status = 0;
+	gettimeofday(&job->started, NULL);
 
 	LIST_INSERT_HEAD(&all_jobs, job, entry);
 
@@ -272,6 +332,16 @@ job_free(struct job *job)
 
 	LIST_REMOVE(job, entry);
 	free(job->cmd);
+	free(job->cwd);
+
+	if (job->queued) {
+		TAILQ_REMOVE(&job_queue, job, queue_entry);
+		job_queue_count--;
+	}
+	if (job->worker != NULL) {
+		/* Let the worker finish and throw the output away. */
+		job->worker->job = NULL;
+	}
 
 	if (job->freecb != NULL && job->data != NULL)
 		job->freecb(job->data);
@@ -357,7 +427,23 @@ job_error_callback(__unused struct bufferevent *bufev, __unused short events,
 void
 job_check_died(pid_t pid, int status)
 {
-	struct job	*job;
+	struct job		*job;
+	struct job_worker	*jw;
+
+	TAILQ_FOREACH(jw, &job_workers, entry) {
+		if (pid == jw->pid)
+			break;
+	}
+	if (jw != NULL) {
+		if (WIFSTOPPED(status)) {
+			kill(jw->pid, SIGCONT);
+			return;
+		}
+		log_debug("job worker died: pid %ld", (long)pid);
+		jw->pid = -1;
+		job_worker_lost(jw, 1 << 8);
+		return;
+	}
 
 	LIST_FOREACH(job, &all_jobs, entry) {
 		if (pid == job->pid)
@@ -410,12 +496,17 @@ job_get_event(struct job *job)
 void
 job_kill_all(void)
 {
-	struct job	*job;
+	struct job		*job;
+	struct job_worker	*jw;
 
 	LIST_FOREACH(job, &all_jobs, entry) {
 		if (job->pid != -1)
 			kill(job->pid, SIGTERM);
 	}
+	TAILQ_FOREACH(jw, &job_workers, entry) {
+		if (jw->pid != -1)
+			killpg(jw->pid, SIGTERM);
+	}
 }
 
 /* Are any jobs still running? */
@@ -432,19 +523,441 @@ job_still_running(void)
 }
 
 /* Print job summary. */
-void
+int
 job_print_summary(struct cmdq_item *item, int blank)
 {
 	struct job	*job;
 	u_int		 n = 0;
+	pid_t		 pid;
+	int		 fd;
+	struct timeval	 now, tv;
 
+	gettimeofday(&now, NULL);
 	LIST_FOREACH(job, &all_jobs, entry) {
 		if (blank) {
 			cmdq_print(item, "%s", "");
 			blank = 0;
 		}
-		cmdq_print(item, "Job %u: %s [fd=%d, pid=%ld, status=%d]",
-		    n, job->cmd, job->fd, (long)job->pid, job->status);
+		if (job->queued) {
+			cmdq_print(item, "Job %u: %s [queued]", n, job->cmd);
+			n++;
+			continue;
+		}
+		if (job->worker != NULL) {
+			pid = job->worker->pid;
+			fd = job->worker->fd;
+		} else {
+			pid = job->pid;
+			fd = job->fd;
+		}
+		timersub(&now, &job->started, &tv);
+		cmdq_print(item, "Job %u: %s [fd=%d, pid=%ld, status=%d, "
+		    "time=%lld.%03ld%s]", n, job->cmd, fd, (long)pid,
+		    job->status, (long long)tv.tv_sec,
+		    (long)tv.tv_usec / 1000,
+		    job->worker != NULL ? ", pooled" : "");
 		n++;
 	}
+	return (n != 0);
+}
+
+/* Get job pool statistics. */
+void
+job_pool_stats(u_int *workers, u_int *busy, u_int *queued, u_int *runs,
+    u_int *last, u_int *average)
+{
+	struct job_worker	*jw;
+
+	*workers = job_workers_count;
+	*busy = 0;
+	TAILQ_FOREACH(jw, &job_workers, entry) {
+		if (jw->busy)
+			(*busy)++;
+	}
+	*queued = job_queue_count;
+	*runs = job_pool_runs;
+	*last = job_pool_last;
+	if (job_pool_runs == 0)
+		*average = 0;
+	else
+		*average = job_pool_total / job_pool_runs;
+}
+
+/* Start a new worker. */
+static struct job_worker *
+job_worker_start(void)
+{
+	struct job_worker	*jw;
+	struct environ		*env;
+	pid_t			 pid;
+	int			 nullfd, out[2];
+	sigset_t		 set, oldset;
+	char			*argv0;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, PF_UNSPEC, out) != 0)
+		return (NULL);
+
+	env = environ_for_session(NULL, !cfg_finished);
+	argv0 = shell_argv0(_PATH_BSHELL, 0);
+
+	sigfillset(&set);
+	sigprocmask(SIG_BLOCK, &set, &oldset);
+	switch (pid = fork()) {
+	case -1:
+		sigprocmask(SIG_SETMASK, &oldset, NULL);
+		environ_free(env);
+		free(argv0);
+		close(out[0]);
+		close(out[1]);
+		return (NULL);
+	case 0:
+		proc_clear_signals(server_proc, 1);
+		sigprocmask(SIG_SETMASK, &oldset, NULL);
+
+		/* Own process group so a hung command can be killed with it. */
+		setpgid(0, 0);
+		if (chdir("/") != 0)
+			_exit(1);
+		environ_push(env);
+		environ_free(env);
+
+		if (dup2(out[1], STDIN_FILENO) == -1)
+			_exit(1);
+		if (dup2(out[1], STDOUT_FILENO) == -1)
+			_exit(1);
+		nullfd = open(_PATH_DEVNULL, O_RDWR);
+		if (nullfd == -1)
+			_exit(1);
+		if (dup2(nullfd, STDERR_FILENO) == -1)
+			_exit(1);
+		closefrom(STDERR_FILENO + 1);
+
+		execl(_PATH_BSHELL, argv0, (char *)NULL);
+		_exit(1);
+	}
+	sigprocmask(SIG_SETMASK, &oldset, NULL);
+	environ_free(env);
+	free(argv0);
+	close(out[1]);
+
+	jw = xcalloc(1, sizeof *jw);
+	jw->pid = pid;
+	jw->fd = out[0];
+	setblocking(jw->fd, 0);
+	evtimer_set(&jw->timer, job_worker_timer_callback, jw);
+
+	jw->event = bufferevent_new(jw->fd, job_worker_read_callback, NULL,
+	    job_worker_error_callback, jw);
+	if (jw->event == NULL)
+		fatalx("out of memory");
+	bufferevent_enable(jw->event, EV_READ|EV_WRITE);
+
+	TAILQ_INSERT_TAIL(&job_workers, jw, entry);
+	job_workers_count++;
+
+	log_debug("start job worker %p: pid %ld", jw, (long)jw->pid);
+	return (jw);
+}
+
+/* Kill and free a worker. */
+static void
+job_worker_free(struct job_worker *jw)
+{
+	log_debug("free job worker %p: pid %ld", jw, (long)jw->pid);
+
+	TAILQ_REMOVE(&job_workers, jw, entry);
+	job_workers_count--;
+	evtimer_del(&jw->timer);
+
+	if (jw->job != NULL)
+		jw->job->worker = NULL;
+
+	if (jw->pid != -1)
+		killpg(jw->pid, SIGTERM);
+	bufferevent_free(jw->event);
+	close(jw->fd);
+	free(jw);
+}
+
+/* Append a string to a buffer quoted for the shell. */
+static void
+job_worker_quote(struct evbuffer *evb, const char *s)
+{
+	evbuffer_add(evb, "'", 1);
+	for (; *s != '\0'; s++) {
+		if (*s == '\'')
+			evbuffer_add(evb, "'\\''", 4);
+		else
+			evbuffer_add(evb, s, 1);
+	}
+	evbuffer_add(evb, "'", 1);
+}
+
+/* Give a job to a worker. */
+static void
+job_worker_send(struct job_worker *jw, struct job *job)
+{
+	struct evbuffer	*evb;
+	struct timeval	 tv;
+	u_int		 timeout;
+	uint32_t	 r[4];
+
+	jw->job = job;
+	jw->busy = 1;
+	job->worker = jw;
+	gettimeofday(&job->started, NULL);
+
+	arc4random_buf(r, sizeof r);
+	xsnprintf(jw->marker, sizeof jw->marker,
+	    "\n\036tmux-job-%08x%08x%08x%08x ", r[0], r[1], r[2], r[3]);
+
+	timeout = options_get_number(global_options, "job-pool-timeout");
+	if (timeout != 0) {
+		tv.tv_sec = timeout;
+		tv.tv_usec = 0;
+		evtimer_add(&jw->timer, &tv);
+	}
+
+	evb = evbuffer_new();
+	if (evb == NULL)
+		fatalx("out of memory");
+	evbuffer_add_printf(evb, "(");
+	if (job->cwd != NULL) {
+		evbuffer_add_printf(evb, "cd ");
+		job_worker_quote(evb, job->cwd);
+		evbuffer_add_printf(evb, " || cd || cd /; ");
+	}
+	evbuffer_add_printf(evb, "eval ");
+	job_worker_quote(evb, job->cmd);
+	evbuffer_add_printf(evb, ") </dev/null 2>/dev/null; printf '%%s%%s\\n' ");
+	job_worker_quote(evb, jw->marker);
+	evbuffer_add_printf(evb, " \"$?\"\n");
+
+	log_debug("send job %p to worker %p: %s", job, jw, job->cmd);
+	bufferevent_write_buffer(jw->event, evb);
+	evbuffer_free(evb);
+}
+
+/*
+ * Start queued jobs if there are free workers and stop idle workers if there
+ * are too many, such as when job-pool-size is made smaller.
+ */
+void
+job_pool_dispatch(void)
+{
+	struct job_worker	*jw, *jw1;
+	struct job		*job;
+	u_int			 limit;
+
+	limit = options_get_number(global_options, "job-pool-size");
+
+	/* Jobs already queued still need a worker if the pool is now empty. */
+	if (limit == 0 && job_queue_count != 0)
+		limit = 1;
+	TAILQ_FOREACH_SAFE(jw, &job_workers, entry, jw1) {
+		if (job_workers_count <= limit)
+			break;
+		if (!jw->busy)
+			job_worker_free(jw);
+	}
+
+	while ((job = TAILQ_FIRST(&job_queue)) != NULL) {
+		TAILQ_FOREACH(jw, &job_workers, entry) {
+			if (!jw->busy)
+				break;
+		}
+		if (jw == NULL) {
+			if (job_workers_count >= limit)
+				break;
+			if ((jw = job_worker_start()) == NULL)
+				break;
+		}
+		TAILQ_REMOVE(&job_queue, job, queue_entry);
+		job_queue_count--;
+		job->queued = 0;
+		job_worker_send(jw, job);
+	}
+}
+
+/* Add a job to the pool. */
+static struct job *
+job_pool_run(const char *cmd, const char *cwd, job_update_cb updatecb,
+    job_complete_cb completecb, job_free_cb freecb, void *data, int flags)
+{
+	struct job	*job;
+
+	job = xcalloc(1, sizeof *job);
+	job->state = JOB_RUNNING;
+	job->flags = flags;
+
+	job->cmd = xstrdup(cmd);
+	if (cwd != NULL)
+		job->cwd = xstrdup(cwd);
+	job->pid = -1;
+	job->fd = -1;
+
+	LIST_INSERT_HEAD(&all_jobs, job, entry);
+
+	job->updatecb = updatecb;
+	job->completecb = completecb;
+	job->freecb = freecb;
+	job->data = data;
+
+	/*
+	 * The input buffer is filled from the worker and the event is never
+	 * enabled, so the buffer must be unfrozen by hand.
+	 */
+	job->event = bufferevent_new(-1, NULL, NULL, NULL, NULL);
+	if (job->event == NULL)
+		fatalx("out of memory");
+	evbuffer_unfreeze(job->event->input, 0);
+
+	TAILQ_INSERT_TAIL(&job_queue, job, queue_entry);
+	job_queue_count++;
+	job->queued = 1;
+
+	log_debug("queue job %p: %s", job, job->cmd);
+	job_pool_dispatch();
+	return (job);
+}
+
+/* Move output from the worker to its job, if it still has one. */
+static void
+job_worker_move(struct job_worker *jw, size_t len)
+{
+	struct job	*job = jw->job;
+	struct evbuffer	*in = jw->event->input;
+
+	if (len == 0)
+		return;
+	if (job == NULL) {
+		evbuffer_drain(in, len);
+		return;
+	}
+	evbuffer_add(job->event->input, EVBUFFER_DATA(in), len);
+	evbuffer_drain(in, len);
+	if (job->updatecb != NULL)
+		job->updatecb(job);
+}
+
+/* The command on a worker has finished. */
+static void
+job_worker_done(struct job_worker *jw, int status)
+{
+	struct job	*job = jw->job;
+	struct timeval	 tv;
+	u_int		 msec;
+
+	jw->job = NULL;
+	jw->busy = 0;
+	jw->runs++;
+	evtimer_del(&jw->timer);
+	if (job == NULL) {
+		log_debug("abandoned job done on worker %p", jw);
+		return;
+	}
+	job->worker = NULL;
+
+	gettimeofday(&tv, NULL);
+	timersub(&tv, &job->started, &tv);
+	msec = tv.tv_sec * 1000 + tv.tv_usec / 1000;
+	log_debug("job %p done on worker %p: %s, status %d, %u ms", job, jw,
+	    job->cmd, status, msec);
+
+	job_pool_runs++;
+	job_pool_last = msec;
+	job_pool_total += msec;
+
+	job->status = status;
+	job->state = JOB_DEAD;
+	if (job->completecb != NULL)
+		job->completecb(job);
+	job_free(job);
+}
+
+/* Worker read callback. */
+static void
+job_worker_read_callback(__unused struct bufferevent *bufev, void *data)
+{
+	struct job_worker	*jw = data;
+	struct evbuffer		*in = jw->event->input;
+	size_t			 len, mlen = strlen(jw->marker), off;
+	u_char			*found, *end;
+	char			 tmp[16];
+	int			 status;
+
+	while ((len = EVBUFFER_LENGTH(in)) != 0) {
+		/* An idle worker has no marker and nothing should be read. */
+		if (!jw->busy) {
+			evbuffer_drain(in, len);
+			break;
+		}
+		found = evbuffer_find(in, jw->marker, mlen);
+		if (found == NULL) {
+			/* Keep enough to match the marker next time. */
+			if (len > mlen)
+				job_worker_move(jw, len - mlen);
+			break;
+		}
+		off = found - EVBUFFER_DATA(in);
+		end = memchr(found + mlen, '\n', len - off - mlen);
+		if (end == NULL) {
+			job_worker_move(jw, off);
+			break;
+		}
+
+		len = end - (found + mlen);
+		if (len >= sizeof tmp)
+			len = sizeof tmp - 1;
+		memcpy(tmp, found + mlen, len);
+		tmp[len] = '\0';
+		status = strtonum(tmp, 0, 255, NULL);
+		len = (end + 1) - found;
+
+		job_worker_move(jw, off);
+		evbuffer_drain(in, len);
+		job_worker_done(jw, status << 8);
+
+		if (jw->runs >= JOB_WORKER_MAX_RUNS) {
+			job_worker_free(jw);
+			break;
+		}
+	}
+	job_pool_dispatch();
+}
+
+/* Worker error callback. */
+static void
+job_worker_error_callback(__unused struct bufferevent *bufev,
+    __unused short events, void *data)
+{
+	struct job_worker	*jw = data;
+
+	log_debug("job worker error %p: pid %ld", jw, (long)jw->pid);
+	job_worker_lost(jw, 1 << 8);
+}
+
+/*
+ * Worker timer callback. The command has run for too long, so free the worker
+ * (which kills it and everything it started) and let a new one take its place.
+ */
+static void
+job_worker_timer_callback(__unused int fd, __unused short events, void *data)
+{
+	struct job_worker	*jw = data;
+
+	log_debug("job worker timeout %p: pid %ld", jw, (long)jw->pid);
+	job_worker_lost(jw, SIGTERM);
+}
+
+/* Worker has gone away, finish its job with this status and free it. */
+static void
+job_worker_lost(struct job_worker *jw, int status)
+{
+	if (jw->busy) {
+		job_worker_move(jw, EVBUFFER_LENGTH(jw->event->input));
+		job_worker_done(jw, status);
+	}
+	job_worker_free(jw);
+	job_pool_dispatch();
 }
@@ -56,6 +56,7 @@ enum mode_tree_preview {
 struct mode_tree_item;
 struct mode_tree_prompt;
 TAILQ_HEAD(mode_tree_list, mode_tree_item);
+RB_HEAD(mode_tree_saved, mode_tree_item);
 
 struct mode_tree_data {
 	int			  dead;
@@ -80,11 +81,15 @@ struct mode_tree_data {
 	mode_tree_help_cb	  helpcb;
 
 	struct mode_tree_list	  children;
-	struct mode_tree_list	  saved;
+	struct mode_tree_saved	  saved;
 
 	struct mode_tree_line	 *line_list;
 	u_int			  line_size;
 
+	struct events_sink	**sinks;
+	u_int			  nsinks;
+	int			  stale;
+
 	u_int			  depth;
 	u_int			  maxdepth;
 
@@ -131,6 +136,7 @@ struct mode_tree_item {
 
 	struct mode_tree_list		 children;
 	TAILQ_ENTRY(mode_tree_item)	 entry;
+	RB_ENTRY(mode_tree_item)	 saved_entry;
 };
 
 struct mode_tree_line {
@@ -225,6 +231,18 @@ static const char* mode_tree_help_end[] = {
 };
 #define MODE_TREE_HELP_DEFAULT_WIDTH 39
 
+static int
+mode_tree_saved_cmp(struct mode_tree_item *mti1, struct mode_tree_item *mti2)
+{
+	if (mti1->tag < mti2->tag)
+		return (-1);
+	if (mti1->tag > mti2->tag)
+		return (1);
+	return (0);
+}
+RB_GENERATE_STATIC(mode_tree_saved, mode_tree_item, saved_entry,
+    mode_tree_saved_cmp);
+
 static int
 mode_tree_is_lowercase(const char *ptr)
 {
@@ -236,21 +254,6 @@ mode_tree_is_lowercase(const char *ptr)
 	return (1);
 }
 
-static struct mode_tree_item *
-mode_tree_find_item(struct mode_tree_list *mtl, uint64_t tag)
-{
-	struct mode_tree_item	*mti, *child;
-
-	TAILQ_FOREACH(mti, mtl, entry) {
-		if (mti->tag == tag)
-			return (mti);
-		child = mode_tree_find_item(&mti->children, tag);
-		if (child != NULL)
-			return (child);
-	}
-	return (NULL);
-}
-
 static void
 mode_tree_free_item(struct mode_tree_item *mti)
 {
@@ -274,6 +277,37 @@ mode_tree_free_items(struct mode_tree_list *mtl)
 	}
 }
 
+/*
+ * Move items into the saved tree so they can be reused by mode_tree_add. If
+ * there is more than one item with the same tag, the first is kept.
+ */
+static void
+mode_tree_save_items(struct mode_tree_data *mtd, struct mode_tree_list *mtl)
+{
+	struct mode_tree_item	*mti, *mti1;
+
+	TAILQ_FOREACH_SAFE(mti, mtl, entry, mti1) {
+		TAILQ_REMOVE(mtl, mti, entry);
+		if (RB_INSERT(mode_tree_saved, &mtd->saved, mti) != NULL) {
+			mode_tree_save_items(mtd, &mti->children);
+			mode_tree_free_item(mti);
+		} else
+			mode_tree_save_items(mtd, &mti->children);
+	}
+}
+
+/* Free any saved items which were not reused. */
+static void
+mode_tree_free_saved(struct mode_tree_data *mtd)
+{
+	struct mode_tree_item	*mti, *mti1;
+
+	RB_FOREACH_SAFE(mti, mode_tree_saved, &mtd->saved, mti1) {
+		RB_REMOVE(mode_tree_saved, &mtd->saved, mti);
+		mode_tree_free_item(mti);
+	}
+}
+
 static void
 mode_tree_check_selected(struct mode_tree_data *mtd)
 {
@@ -293,22 +327,33 @@ mode_tree_clear_lines(struct mode_tree_data *mtd)
 	mtd->line_size = 0;
 }
 
+static u_int
+mode_tree_count_lines(struct mode_tree_list *mtl)
+{
+	struct mode_tree_item	*mti;
+	u_int			 n = 0;
+
+	TAILQ_FOREACH(mti, mtl, entry) {
+		n++;
+		if (mti->expanded)
+			n += mode_tree_count_lines(&mti->children);
+	}
+	return (n);
+}
+
+/* Build lines into line_list, which must be big enough for them all. */
 static void
 mode_tree_build_lines(struct mode_tree_data *mtd,
     struct mode_tree_list *mtl, u_int depth)
 {
 	struct mode_tree_item	*mti;
 	struct mode_tree_line	*line;
-	u_int			 i;
 	int			 flat = 1;
 
 	mtd->depth = depth;
 	if (depth > mtd->maxdepth)
 		mtd->maxdepth = depth;
 	TAILQ_FOREACH(mti, mtl, entry) {
-		mtd->line_list = xreallocarray(mtd->line_list,
-		    mtd->line_size + 1, sizeof *mtd->line_list);
-
 		line = &mtd->line_list[mtd->line_size++];
 		line->item = mti;
 		line->depth = depth;
@@ -331,6 +376,7 @@ mode_tree_build_lines(struct mode_tree_data *mtd,
 			mti->key = KEYC_META|('a' + mti->line - 10);
 		else
 			mti->key = KEYC_NONE;
+		free((void *)mti->keystr);
 		if (mti->key != KEYC_NONE) {
 			mti->keystr = xstrdup(key_string_lookup_key(mti->key,
 			    0));
@@ -340,13 +386,8 @@ mode_tree_build_lines(struct mode_tree_data *mtd,
 			mti->keylen = 0;
 		}
 	}
-	TAILQ_FOREACH(mti, mtl, entry) {
-		for (i = 0; i < mtd->line_size; i++) {
-			line = &mtd->line_list[i];
-			if (line->item == mti)
-				line->flat = flat;
-		}
-	}
+	TAILQ_FOREACH(mti, mtl, entry)
+		mtd->line_list[mti->line].flat = flat;
 }
 
 static void
@@ -602,6 +643,7 @@ mode_tree_start(struct window_pane *wp, struct args *args,
 	mtd->helpcb = helpcb;
 
 	TAILQ_INIT(&mtd->children);
+	RB_INIT(&mtd->saved);
 
 	*s = &mtd->screen;
 	screen_init(*s, screen_size_x(&wp->base), screen_size_y(&wp->base), 0);
@@ -658,14 +700,14 @@ mode_tree_build(struct mode_tree_data *mtd)
 {
 	struct screen	*s = &mtd->screen;
 	uint64_t	 tag;
+	u_int		 n;
 
 	if (mtd->line_list != NULL)
 		tag = mtd->line_list[mtd->current].item->tag;
 	else
 		tag = UINT64_MAX;
 
-	TAILQ_CONCAT(&mtd->saved, &mtd->children, entry);
-	TAILQ_INIT(&mtd->children);
+	mode_tree_save_items(mtd, &mtd->children);
 
 	if (mtd->sortcb != NULL)
 		mtd->sortcb(&mtd->sort_crit);
@@ -674,16 +716,20 @@ mode_tree_build(struct mode_tree_data *mtd)
 	if (mtd->no_matches)
 		mtd->buildcb(mtd->modedata, &mtd->sort_crit, &tag, NULL);
 
-	mode_tree_free_items(&mtd->saved);
-	TAILQ_INIT(&mtd->saved);
+	mode_tree_free_saved(mtd);
 
 	mode_tree_clear_lines(mtd);
 	mtd->maxdepth = 0;
-	mode_tree_build_lines(mtd, &mtd->children, 0);
+	n = mode_tree_count_lines(&mtd->children);
+	if (n != 0) {
+		mtd->line_list = xreallocarray(NULL, n, sizeof *mtd->line_list);
+		mode_tree_build_lines(mtd, &mtd->children, 0);
+	}
 
 	if (mtd->line_list != NULL && tag == UINT64_MAX)
 		tag = mtd->line_list[mtd->current].item->tag;
 	mode_tree_set_current(mtd, tag);
+	mtd->stale = 0;
 
 	mtd->width = screen_size_x(s);
 	if (mtd->preview != MODE_TREE_PREVIEW_OFF)
@@ -693,6 +739,89 @@ mode_tree_build(struct mode_tree_data *mtd)
 	mode_tree_check_selected(mtd);
 }
 
+static void
+mode_tree_event_cb(__unused const char *name,
+    __unused struct event_payload *ep, void *sink_data)
+{
+	struct mode_tree_data	*mtd = sink_data;
+
+	if (!mtd->stale) {
+		mtd->stale = 1;
+		server_status_window(mtd->wp->window);
+	}
+}
+
+/*
+ * Mark the tree to be built again when any of a list of events is fired. The
+ * status line is redrawn so mode_tree_update is called at the end of the loop.
+ */
+void
+mode_tree_watch(struct mode_tree_data *mtd, const char **names)
+{
+	u_int	i;
+
+	for (i = 0; names[i] != NULL; i++) {
+		mtd->sinks = xreallocarray(mtd->sinks, mtd->nsinks + 1,
+		    sizeof *mtd->sinks);
+		mtd->sinks[mtd->nsinks++] = events_add_sink(names[i],
+		    mode_tree_event_cb, mtd);
+	}
+}
+
+/*
+ * Can the tree be kept until an event is fired? Not if there is a filter or
+ * the sort order can change without any event, such as by activity time.
+ */
+static int
+mode_tree_can_keep(struct mode_tree_data *mtd)
+{
+	if (mtd->nsinks == 0 || mtd->stale || mtd->filter != NULL)
+		return (0);
+	switch (mtd->sort_crit.order) {
+	case SORT_CREATION:
+	case SORT_INDEX:
+	case SORT_NAME:
+	case SORT_ORDER:
+		return (1);
+	default:
+		return (0);
+	}
+}
+
+/*
+ * Update the tree. If it is watching events, none have been fired since it was
+ * last built and it has no filter or sort order which needs it to be built
+ * again, only the text of items on screen is updated.
+ */
+void
+mode_tree_update(struct mode_tree_data *mtd, mode_tree_text_cb textcb)
+{
+	struct mode_tree_item	*mti;
+	u_int			 i, end;
+	char			*text;
+
+	if (!mode_tree_can_keep(mtd)) {
+		mode_tree_build(mtd);
+		return;
+	}
+
+	end = mtd->offset + mtd->height;
+	if (end > mtd->line_size)
+		end = mtd->line_size;
+	for (i = mtd->offset; i < end; i++) {
+		mti = mtd->line_list[i].item;
+		text = textcb(mtd->modedata, mti->itemdata);
+		if (text == NULL)
+			continue;
+		if (mti->text != NULL && strcmp(mti->text, text) == 0)
+			free(text);
+		else {
+			free((void *)mti->text);
+			mti->text = text;
+		}
+	}
+}
+
 static void
 mode_tree_remove_ref(struct mode_tree_data *mtd)
 {
@@ -704,10 +833,15 @@ void
 mode_tree_free(struct mode_tree_data *mtd)
 {
 	struct window_pane	*wp = mtd->wp;
+	u_int			 i;
 
 	if (mtd->zoomed == 0)
 		server_unzoom_window(wp->window);
 
+	for (i = 0; i < mtd->nsinks; i++)
+		events_remove_sink(mtd->sinks[i]);
+	free(mtd->sinks);
+
 	mode_tree_clear_prompt(mtd);
 	mode_tree_free_items(&mtd->children);
 	mode_tree_clear_lines(mtd);
@@ -738,30 +872,50 @@ mode_tree_add(struct mode_tree_data *mtd, struct mode_tree_item *parent,
     void *itemdata, uint64_t tag, const char *name, const char *text,
     int expanded)
 {
-	struct mode_tree_item	*mti, *saved;
+	struct mode_tree_item	*mti, find;
 
 	log_debug("%s: %llu, %s %s", __func__, (unsigned long long)tag,
 	    name, (text == NULL ? "" : text));
 
-	mti = xcalloc(1, sizeof *mti);
+	/*
+	 * Reuse the item from the last build if there is one, keeping whether
+	 * it was tagged or expanded.
+	 */
+	find.tag = tag;
+	mti = RB_FIND(mode_tree_saved, &mtd->saved, &find);
+	if (mti != NULL) {
+		RB_REMOVE(mode_tree_saved, &mtd->saved, mti);
+		if (parent != NULL && !parent->expanded)
+			mti->tagged = 0;
+
+		if (strcmp(mti->name, name) != 0) {
+			free((void *)mti->name);
+			mti->name = xstrdup(name);
+		}
+		if (text == NULL || mti->text == NULL ||
+		    strcmp(mti->text, text) != 0) {
+			free((void *)mti->text);
+			mti->text = (text == NULL ? NULL : xstrdup(text));
+		}
+
+		mti->draw_as_parent = 0;
+		mti->no_tag = 0;
+		mti->align = 0;
+	} else {
+		mti = xcalloc(1, sizeof *mti);
+		mti->tag = tag;
+		mti->name = xstrdup(name);
+		if (text != NULL)
+			mti->text = xstrdup(text);
+
+		if (expanded == -1)
+			mti->expanded = 1;
+		else
+			mti->expanded = expanded;
+	}
 	mti->parent = parent;
 	mti->itemdata = itemdata;
 
-	mti->tag = tag;
-	mti->name = xstrdup(name);
-	if (text != NULL)
-		mti->text = xstrdup(text);
-
-	saved = mode_tree_find_item(&mtd->saved, tag);
-	if (saved != NULL) {
-		if (parent == NULL || parent->expanded)
-			mti->tagged = saved->tagged;
-		mti->expanded = saved->expanded;
-	} else if (expanded == -1)
-		mti->expanded = 1;
-	else
-		mti->expanded = expanded;
-
 	TAILQ_INIT(&mti->children);
 
 	if (parent != NULL)
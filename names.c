@@ -22,9 +22,30 @@
 #include <libgen.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "tmux.h"
 
+/*
+ * The foreground command name and working directory of each pane are cached.
+ * They are fetched again at once if the foreground process group changes,
+ * which tcgetpgrp can tell cheaply. Panes which have had output since they
+ * were fetched (which is when a shell could have changed directory) or which
+ * are older than NAME_PROC_LIFETIME seconds (in case the process group leader
+ * has replaced itself with exec) are fetched again together in a single pass
+ * over all panes, at most once every NAME_PROC_INTERVAL milliseconds.
+ */
+#define NAME_PROC_LIFETIME 5
+#define NAME_PROC_INTERVAL 1000
+
+static uint64_t	 name_proc_last;
+
+static u_int	 name_lookups;
+static u_int	 name_lookups_second;
+static u_int	 name_lookups_last;
+static time_t	 name_lookups_time;
+
 static void	 name_time_callback(int, short, void *);
 static int	 name_time_expired(struct window *, struct timeval *);
 
@@ -104,6 +125,156 @@ check_window_name(struct window *w)
 	free(name);
 }
 
+/* Count a command name lookup. */
+static void
+name_count_lookup(time_t t)
+{
+	if (t != name_lookups_time) {
+		if (t == name_lookups_time + 1)
+			name_lookups_last = name_lookups_second;
+		else
+			name_lookups_last = 0;
+		name_lookups_second = 0;
+		name_lookups_time = t;
+	}
+	name_lookups_second++;
+	name_lookups++;
+}
+
+/* Get command name lookup statistics. */
+void
+name_lookup_stats(u_int *total, u_int *last)
+{
+	time_t	t = time(NULL);
+
+	*total = name_lookups;
+	if (t == name_lookups_time)
+		*last = name_lookups_last;
+	else if (t == name_lookups_time + 1)
+		*last = name_lookups_second;
+	else
+		*last = 0;
+}
+
+/* Fetch cached process information for a pane. */
+static void
+name_proc_fetch(struct window_pane *wp, pid_t pgrp, time_t t, int flags)
+{
+	struct window_pane_proc	*wpp = &wp->proc;
+	char			*cwd;
+	int			 cached;
+
+	if (flags & PANE_PROC_NAME) {
+		free(wpp->name);
+		wpp->name = osdep_get_name(wp->fd, wp->tty);
+		name_count_lookup(t);
+	}
+	if (flags & PANE_PROC_CWD) {
+		free(wpp->cwd);
+		if ((cwd = osdep_get_cwd(wp->fd)) != NULL)
+			wpp->cwd = xstrdup(cwd);
+		else
+			wpp->cwd = NULL;
+		name_count_lookup(t);
+	}
+	cached = wpp->flags & (PANE_PROC_NAME|PANE_PROC_CWD);
+	if (pgrp != wpp->pgrp || (flags & cached) == cached)
+		wpp->time = t;
+	wpp->pgrp = pgrp;
+	wpp->flags = (wpp->flags|flags) & ~PANE_PROC_STALE;
+
+	log_debug("%%%u command is %s, path is %s (process group %ld)",
+	    wp->id, wpp->name == NULL ? "unknown" : wpp->name,
+	    wpp->cwd == NULL ? "unknown" : wpp->cwd, (long)pgrp);
+}
+
+/* Fetch process information again for all panes where it may be stale. */
+static void
+name_proc_refresh(time_t t)
+{
+	struct window_pane	*wp;
+	struct window_pane_proc	*wpp;
+	uint64_t		 now = get_timer();
+	pid_t			 pgrp;
+	u_int			 n = 0;
+
+	if (name_proc_last != 0 && now - name_proc_last < NAME_PROC_INTERVAL)
+		return;
+	name_proc_last = now;
+
+	RB_FOREACH(wp, window_pane_tree, &all_window_panes) {
+		wpp = &wp->proc;
+		if ((wpp->flags & (PANE_PROC_NAME|PANE_PROC_CWD)) == 0)
+			continue;
+		if (wp->fd == -1 || (pgrp = tcgetpgrp(wp->fd)) == -1)
+			continue;
+		if (pgrp == wpp->pgrp &&
+		    (~wpp->flags & PANE_PROC_STALE) &&
+		    t >= wpp->time &&
+		    t - wpp->time < NAME_PROC_LIFETIME)
+			continue;
+		name_proc_fetch(wp, pgrp, t, wpp->flags);
+		n++;
+	}
+	if (n != 0)
+		log_debug("%s: %u panes refreshed", __func__, n);
+}
+
+/* Get cached process information for a pane. */
+static struct window_pane_proc *
+name_proc_get(struct window_pane *wp, int flag, int now)
+{
+	struct window_pane_proc	*wpp = &wp->proc;
+	pid_t			 pgrp;
+	time_t			 t;
+
+	if (wp->fd == -1 || (pgrp = tcgetpgrp(wp->fd)) == -1) {
+		free(wpp->name);
+		wpp->name = NULL;
+		free(wpp->cwd);
+		wpp->cwd = NULL;
+		wpp->pgrp = -1;
+		wpp->flags = 0;
+		return (NULL);
+	}
+
+	t = time(NULL);
+	if (pgrp != wpp->pgrp)
+		name_proc_fetch(wp, pgrp, t, wpp->flags|flag);
+	else if (~wpp->flags & flag)
+		name_proc_fetch(wp, pgrp, t, flag);
+	else if (now && (wpp->flags & PANE_PROC_STALE))
+		name_proc_fetch(wp, pgrp, t, flag);
+	else
+		name_proc_refresh(t);
+	return (wpp);
+}
+
+/* Get the name of the foreground command in a pane, or NULL. */
+const char *
+get_pane_command(struct window_pane *wp)
+{
+	struct window_pane_proc	*wpp;
+
+	if ((wpp = name_proc_get(wp, PANE_PROC_NAME, 0)) == NULL)
+		return (NULL);
+	return (wpp->name);
+}
+
+/*
+ * Get the working directory of the foreground command in a pane, or NULL. If
+ * now is set and the pane has had output, do not wait for the next refresh.
+ */
+const char *
+get_pane_cwd(struct window_pane *wp, int now)
+{
+	struct window_pane_proc	*wpp;
+
+	if ((wpp = name_proc_get(wp, PANE_PROC_CWD, now)) == NULL)
+		return (NULL);
+	return (wpp->cwd);
+}
+
 char *
 default_window_name(struct window *w)
 {
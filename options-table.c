@@ -305,6 +305,27 @@ const struct options_table_entry options_table[] = {
 		  "When this is reached, the oldest buffer is deleted."
 	},
 
+	{ .name = "buffer-memory-limit",
+	  .type = OPTIONS_TABLE_NUMBER,
+	  .scope = OPTIONS_TABLE_SERVER,
+	  .minimum = 0,
+	  .maximum = INT_MAX,
+	  .default_num = 0,
+	  .text = "The maximum number of bytes used by buffer contents. "
+		  "When this is exceeded, the oldest automatic buffers are "
+		  "deleted. Zero means no limit."
+	},
+
+	{ .name = "coalesce-events",
+	  .type = OPTIONS_TABLE_STRING,
+	  .scope = OPTIONS_TABLE_SERVER,
+	  .flags = OPTIONS_TABLE_IS_ARRAY,
+	  .default_str = "",
+	  .separator = ",",
+	  .text = "Array of events which are fired at the end of the server "
+		  "loop, keeping only the last for each target."
+	},
+
 	{ .name = "command-alias",
 	  .type = OPTIONS_TABLE_STRING,
 	  .scope = OPTIONS_TABLE_SERVER,
@@ -443,6 +464,16 @@ const struct options_table_entry options_table[] = {
 		  "Empty does not write a history file."
 	},
 
+	{ .name = "image-memory-limit",
+	  .type = OPTIONS_TABLE_NUMBER,
+	  .scope = OPTIONS_TABLE_SERVER,
+	  .minimum = 0,
+	  .maximum = INT_MAX,
+	  .default_num = 64 * 1024 * 1024,
+	  .text = "Maximum number of bytes used by images. "
+		  "When this is reached, old and large images are deleted."
+	},
+
 	{ .name = "input-buffer-size",
 	  .type = OPTIONS_TABLE_NUMBER,
 	  .scope = OPTIONS_TABLE_SERVER,
@@ -452,6 +483,27 @@ const struct options_table_entry options_table[] = {
 	  .text = "Number of bytes accepted in a single input before dropping."
 	},
 
+	{ .name = "job-pool-size",
+	  .type = OPTIONS_TABLE_NUMBER,
+	  .scope = OPTIONS_TABLE_SERVER,
+	  .minimum = 0,
+	  .maximum = 1000,
+	  .default_num = 0,
+	  .text = "Number of long-lived shells used to run commands in "
+		  "formats. Zero starts a new process for each command."
+	},
+
+	{ .name = "job-pool-timeout",
+	  .type = OPTIONS_TABLE_NUMBER,
+	  .scope = OPTIONS_TABLE_SERVER,
+	  .minimum = 0,
+	  .maximum = INT_MAX,
+	  .default_num = 30,
+	  .unit = "seconds",
+	  .text = "Time after which a command run by the job pool is killed "
+		  "and its shell replaced. Zero means no limit."
+	},
+
 	{ .name = "menu-style",
 	  .type = OPTIONS_TABLE_STRING,
 	  .scope = OPTIONS_TABLE_WINDOW,
@@ -497,6 +549,16 @@ const struct options_table_entry options_table[] = {
 	  .text = "Maximum number of server messages to keep."
 	},
 
+	{ .name = "paste-rate-limit",
+	  .type = OPTIONS_TABLE_NUMBER,
+	  .scope = OPTIONS_TABLE_SERVER,
+	  .minimum = 0,
+	  .maximum = INT_MAX,
+	  .default_num = 0,
+	  .text = "Maximum number of bytes per second written to a pane by "
+		  "'paste-buffer'. Zero means no limit."
+	},
+
 	{ .name = "prefix-timeout",
 	  .type = OPTIONS_TABLE_NUMBER,
 	  .scope = OPTIONS_TABLE_SERVER,
@@ -2033,6 +2095,8 @@ const struct options_table_entry options_table[] = {
 	    "Run when a session is removed from a session group."),
 	OPTIONS_TABLE_HOOK("session-window-changed", "",
 	    "Run when a session changes its active window."),
+	OPTIONS_TABLE_HOOK("session-windows-changed", "",
+	    "Run when windows in a session are swapped or renumbered."),
 	OPTIONS_TABLE_WINDOW_HOOK("window-created", "",
 	    "Run when a window is created."),
 	OPTIONS_TABLE_WINDOW_HOOK("window-closed", "",
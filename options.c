@@ -115,11 +115,19 @@ struct options_entry {
 	RB_ENTRY(options_entry)			 entry;
 };
 
+/*
+ * Options from the table also have an ID (their index in the table) and each
+ * set of options has an array of them by ID, so they can be found without
+ * comparing names. This is used by options_handle for frequently read options.
+ */
 struct options {
 	RB_HEAD(options_tree, options_entry)	 tree;
+	struct options_entry			**index;
 	struct options				*parent;
 };
 
+static u_int			 options_table_size;
+
 static struct options_entry	*options_add(struct options *, const char *);
 static void			 options_remove(struct options_entry *);
 
@@ -140,6 +148,9 @@ static void			 options_remove(struct options_entry *);
 #define OPTIONS_IS_ARRAY(o)						\
 	((o)->tableentry != NULL &&					\
 	    ((o)->tableentry->flags & OPTIONS_TABLE_IS_ARRAY))
+#define OPTIONS_IS_HOOK(o)						\
+	((o)->tableentry != NULL &&					\
+	    ((o)->tableentry->flags & OPTIONS_TABLE_IS_HOOK))
 
 static int	options_cmp(struct options_entry *, struct options_entry *);
 RB_GENERATE_STATIC(options_tree, options_entry, entry, options_cmp);
@@ -240,6 +251,7 @@ options_free(struct options *oo)
 
 	RB_FOREACH_SAFE(o, options_tree, &oo->tree, tmp)
 		options_remove(o);
+	free(oo->index);
 	free(oo);
 }
 
@@ -295,14 +307,54 @@ options_get(struct options *oo, const char *name)
 	return (o);
 }
 
+/* Get the ID of a table entry. */
+static u_int
+options_table_id(const struct options_table_entry *oe)
+{
+	const struct options_table_entry	*loop;
+
+	if (options_table_size == 0) {
+		for (loop = options_table; loop->name != NULL; loop++)
+			options_table_size++;
+	}
+	if (oe < options_table || oe >= options_table + options_table_size)
+		fatalx("option %s not in table", oe->name);
+	return (oe - options_table);
+}
+
+/* Get an option by handle, looking up the ID on first use. */
+struct options_entry *
+options_get_handle(struct options *oo, struct options_handle *oh)
+{
+	const struct options_table_entry	*oe;
+	struct options_entry			*o;
+
+	if (oh->id == -1) {
+		oe = options_search(oh->name);
+		if (oe == NULL)
+			fatalx("unknown option %s", oh->name);
+		oh->id = options_table_id(oe);
+	}
+	for (; oo != NULL; oo = oo->parent) {
+		if (oo->index != NULL && (o = oo->index[oh->id]) != NULL)
+			return (o);
+	}
+	return (NULL);
+}
+
 struct options_entry *
 options_empty(struct options *oo, const struct options_table_entry *oe)
 {
 	struct options_entry	*o;
+	u_int			 id = options_table_id(oe);
 
 	o = options_add(oo, oe->name);
 	o->tableentry = oe;
 
+	if (oo->index == NULL)
+		oo->index = xcalloc(options_table_size, sizeof *oo->index);
+	oo->index[id] = o;
+
 	if (oe->flags & OPTIONS_TABLE_IS_ARRAY)
 		RB_INIT(&o->value.array);
 
@@ -414,6 +466,8 @@ options_remove(struct options_entry *o)
 		options_value_free(o, &o->value);
 	if (o->monitor_data != NULL)
 		hooks_monitor_free(o->monitor_data);
+	if (o->tableentry != NULL)
+		oo->index[options_table_id(o->tableentry)] = NULL;
 	RB_REMOVE(options_tree, &oo->tree, o);
 	free((void *)o->name);
 	free(o);
@@ -485,6 +539,9 @@ options_array_new(struct options_entry *o, const char *key)
 	a = xcalloc(1, sizeof *a);
 	a->key = xstrdup(key);
 	RB_INSERT(options_array, &o->value.array, a);
+
+	if (OPTIONS_IS_HOOK(o))
+		hooks_count_command(o->name, 1);
 	return (a);
 }
 
@@ -495,6 +552,9 @@ options_array_free(struct options_entry *o, struct options_array_item *a)
 	RB_REMOVE(options_array, &o->value.array, a);
 	free(a->key);
 	free(a);
+
+	if (OPTIONS_IS_HOOK(o))
+		hooks_count_command(o->name, 0);
 }
 
 void
@@ -899,6 +959,32 @@ options_get_string(struct options *oo, const char *name)
 	return (o->value.string);
 }
 
+const char *
+options_get_string_handle(struct options *oo, struct options_handle *oh)
+{
+	struct options_entry	*o;
+
+	o = options_get_handle(oo, oh);
+	if (o == NULL)
+		fatalx("missing option %s", oh->name);
+	if (!OPTIONS_IS_STRING(o))
+		fatalx("option %s is not a string", oh->name);
+	return (o->value.string);
+}
+
+long long
+options_get_number_handle(struct options *oo, struct options_handle *oh)
+{
+	struct options_entry	*o;
+
+	o = options_get_handle(oo, oh);
+	if (o == NULL)
+		fatalx("missing option %s", oh->name);
+	if (!OPTIONS_IS_NUMBER(o))
+		fatalx("option %s is not a number", oh->name);
+	return (o->value.number);
+}
+
 long long
 options_get_number(struct options *oo, const char *name)
 {
@@ -1384,6 +1470,10 @@ options_push_changes(const char *name)
 				w->active->flags |= PANE_CHANGED;
 		}
 	}
+	if (strcmp(name, "coalesce-events") == 0)
+		events_update_coalesce();
+	if (strcmp(name, "command-alias") == 0)
+		control_flush_parse_cache();
 	if (strcmp(name, "cursor-colour") == 0) {
 		RB_FOREACH(wp, window_pane_tree, &all_window_panes)
 			window_pane_default_cursor(wp);
@@ -1396,6 +1486,8 @@ options_push_changes(const char *name)
 		RB_FOREACH(w, windows, &windows)
 			window_set_fill_cells(w);
 	}
+	if (strcmp(name, "job-pool-size") == 0)
+		job_pool_dispatch();
 	if (strcmp(name, "key-table") == 0) {
 		TAILQ_FOREACH(loop, &clients, entry)
 			server_client_set_key_table(loop, NULL);
@@ -27,13 +27,31 @@
 /*
  * Set of paste buffers. Note that paste buffer data is not necessarily a C
  * string!
+ *
+ * Buffer contents are stored once for each distinct content and shared by
+ * reference between buffers, so copying the same text repeatedly does not use
+ * any more memory.
  */
 
+struct paste_data {
+	char			*data;
+	size_t			 size;
+	uint64_t		 hash;
+	u_int			 references;
+
+	RB_ENTRY(paste_data)	 entry;
+};
+
 static u_int	paste_next_index;
 static u_int	paste_next_order;
 static u_int	paste_num_automatic;
 static RB_HEAD(paste_name_tree, paste_buffer) paste_by_name;
 static RB_HEAD(paste_time_tree, paste_buffer) paste_by_time;
+static RB_HEAD(paste_data_tree, paste_data) paste_contents =
+    RB_INITIALIZER(&paste_contents);
+
+static size_t	paste_stored_size;
+static size_t	paste_total_size;
 
 static int	paste_cmp_names(const struct paste_buffer *,
 		    const struct paste_buffer *);
@@ -43,6 +61,10 @@ static int	paste_cmp_times(const struct paste_buffer *,
 		    const struct paste_buffer *);
 RB_GENERATE_STATIC(paste_time_tree, paste_buffer, time_entry, paste_cmp_times);
 
+static int	paste_cmp_data(const struct paste_data *,
+		    const struct paste_data *);
+RB_GENERATE_STATIC(paste_data_tree, paste_data, entry, paste_cmp_data);
+
 static void
 paste_fire_event(const char *name, const char *pbname)
 {
@@ -69,6 +91,104 @@ paste_cmp_times(const struct paste_buffer *a, const struct paste_buffer *b)
 	return (0);
 }
 
+static int
+paste_cmp_data(const struct paste_data *a, const struct paste_data *b)
+{
+	if (a->hash < b->hash)
+		return (-1);
+	if (a->hash > b->hash)
+		return (1);
+	if (a->size < b->size)
+		return (-1);
+	if (a->size > b->size)
+		return (1);
+	return (memcmp(a->data, b->data, a->size));
+}
+
+/* Hash paste buffer contents (FNV-1a). */
+static uint64_t
+paste_hash(const char *data, size_t size)
+{
+	const u_char	*cp = (const u_char *)data, *end = cp + size;
+	uint64_t	 hash = 14695981039346656037ULL;
+
+	for (; cp != end; cp++) {
+		hash ^= *cp;
+		hash *= 1099511628211ULL;
+	}
+	return (hash);
+}
+
+/*
+ * Find or create the stored contents for some data. The data is either kept
+ * or freed.
+ */
+static struct paste_data *
+paste_data_get(char *data, size_t size)
+{
+	struct paste_data	 find, *pd;
+
+	find.data = data;
+	find.size = size;
+	find.hash = paste_hash(data, size);
+	if ((pd = RB_FIND(paste_data_tree, &paste_contents, &find)) != NULL) {
+		log_debug("%s: sharing %zu bytes", __func__, size);
+		free(data);
+	} else {
+		pd = xcalloc(1, sizeof *pd);
+		pd->data = data;
+		pd->size = size;
+		pd->hash = find.hash;
+		RB_INSERT(paste_data_tree, &paste_contents, pd);
+		paste_stored_size += size;
+	}
+	pd->references++;
+	paste_total_size += size;
+	return (pd);
+}
+
+/* Drop a reference to stored contents, freeing them if unused. */
+static void
+paste_data_release(struct paste_data *pd)
+{
+	paste_total_size -= pd->size;
+	if (--pd->references != 0)
+		return;
+	RB_REMOVE(paste_data_tree, &paste_contents, pd);
+	paste_stored_size -= pd->size;
+	free(pd->data);
+	free(pd);
+}
+
+/*
+ * Delete the oldest automatic buffers until the contents fit in the memory
+ * limit. The given buffer is never deleted.
+ */
+static void
+paste_trim(struct paste_buffer *keep)
+{
+	struct paste_buffer	*pb, *pb1;
+	size_t			 limit;
+
+	limit = options_get_number(global_options, "buffer-memory-limit");
+	if (limit == 0)
+		return;
+	RB_FOREACH_REVERSE_SAFE(pb, paste_time_tree, &paste_by_time, pb1) {
+		if (paste_stored_size <= limit)
+			break;
+		if (pb->automatic && pb != keep)
+			paste_free(pb);
+	}
+}
+
+/* Get paste buffer memory statistics. */
+void
+paste_stats(size_t *stored, size_t *saved)
+{
+	*stored = paste_stored_size;
+	*saved = paste_total_size - paste_stored_size;
+}
+
 /* Get paste buffer name. */
 const char *
 paste_buffer_name(struct paste_buffer *pb)
@@ -96,7 +216,7 @@ paste_buffer_data(struct paste_buffer *pb, size_t *size)
 {
 	if (size != NULL)
 		*size = pb->size;
-	return (pb->data);
+	return (pb->pd->data);
 }
 
 /* Walk paste buffers by time. */
@@ -154,7 +274,7 @@ paste_free(struct paste_buffer *pb)
 	if (pb->automatic)
 		paste_num_automatic--;
 
-	free(pb->data);
+	paste_data_release(pb->pd);
 	free(pb->name);
 	free(pb);
 }
@@ -193,7 +313,7 @@ paste_add(const char *prefix, char *data, size_t size)
 		paste_next_index++;
 	} while (paste_get_name(pb->name) != NULL);
 
-	pb->data = data;
+	pb->pd = paste_data_get(data, size);
 	pb->size = size;
 
 	pb->automatic = 1;
@@ -206,6 +326,7 @@ paste_add(const char *prefix, char *data, size_t size)
 	RB_INSERT(paste_time_tree, &paste_by_time, pb);
 
 	paste_fire_event("paste-buffer-changed", pb->name);
+	paste_trim(pb);
 }
 
 /* Rename a paste buffer. */
@@ -307,7 +428,7 @@ paste_set(char *data, size_t size, const char *name, char **cause)
 	pb = xmalloc(sizeof *pb);
 	pb->name = newname;
 
-	pb->data = data;
+	pb->pd = paste_data_get(data, size);
 	pb->size = size;
 
 	pb->automatic = 0;
@@ -322,6 +443,7 @@ paste_set(char *data, size_t size, const char *name, char **cause)
 	RB_INSERT(paste_time_tree, &paste_by_time, pb);
 
 	paste_fire_event("paste-buffer-changed", pb->name);
+	paste_trim(pb);
 
 	return (0);
 }
@@ -330,11 +452,12 @@ paste_set(char *data, size_t size, const char *name, char **cause)
 void
 paste_replace(struct paste_buffer *pb, char *data, size_t size)
 {
-	free(pb->data);
-	pb->data = data;
+	paste_data_release(pb->pd);
+	pb->pd = paste_data_get(data, size);
 	pb->size = size;
 
 	paste_fire_event("paste-buffer-changed", pb->name);
+	paste_trim(pb);
 }
 
 /* Convert start of buffer into a nice string. */
@@ -351,8 +474,207 @@ paste_make_sample(struct paste_buffer *pb)
 		len = width;
 	buf = xreallocarray(NULL, len, 4 + 4);
 
-	used = utf8_strvis(buf, pb->data, len, flags);
+	used = utf8_strvis(buf, pb->pd->data, len, flags);
 	if (pb->size > width || used > width)
 		strlcpy(buf + width, "...", 4);
 	return (buf);
 }
+
+/* Write part of a line of a paste into a pane. */
+static void
+paste_send_line(struct window_pane *wp, struct window_pane_paste *wpp,
+    const char *data, size_t len)
+{
+	char	*cp;
+	size_t	 n;
+
+	if (wpp->flags & PASTE_RAW) {
+		bufferevent_write(wp->event, data, len);
+		return;
+	}
+	n = utf8_stravisx(&cp, data, len, VIS_SAFE|VIS_NOSLASH);
+	bufferevent_write(wp->event, cp, n);
+	free(cp);
+}
+
+/*
+ * Write up to the given amount of a paste into a pane. Chunks end after a
+ * newline if there is one, otherwise they are not allowed to split a UTF-8
+ * character.
+ */
+static void
+paste_send_chunk(struct window_pane *wp, struct window_pane_paste *wpp,
+    size_t max)
+{
+	const char	*data = wpp->pd->data + wpp->offset, *end, *line;
+	size_t		 n = wpp->size - wpp->offset, seplen;
+
+	if (wpp->offset == 0 &&
+	    (wpp->flags & PASTE_BRACKET) &&
+	    (wp->screen->mode & MODE_BRACKETPASTE)) {
+		bufferevent_write(wp->event, "\033[200~", 6);
+		wpp->flags |= PASTE_BRACKETED;
+	}
+
+	if (n > max) {
+		n = max;
+		while (n != 0 && data[n - 1] != '\n')
+			n--;
+		if (n == 0) {
+			n = max;
+			while (n != 0 && (data[n] & 0xc0) == 0x80)
+				n--;
+			if (n == 0)
+				n = max;
+		}
+	}
+	end = data + n;
+	wpp->offset += n;
+
+	seplen = strlen(wpp->separator);
+	while ((line = memchr(data, '\n', end - data)) != NULL) {
+		paste_send_line(wp, wpp, data, line - data);
+		bufferevent_write(wp->event, wpp->separator, seplen);
+		data = line + 1;
+	}
+	if (data != end)
+		paste_send_line(wp, wpp, data, end - data);
+
+	if (wpp->offset == wpp->size && (wpp->flags & PASTE_BRACKETED))
+		bufferevent_write(wp->event, "\033[201~", 6);
+}
+
+/* Free a paste. */
+static void
+paste_send_free(struct window_pane *wp, struct window_pane_paste *wpp)
+{
+	TAILQ_REMOVE(&wp->pastes, wpp, entry);
+	paste_data_release(wpp->pd);
+	free(wpp->separator);
+	free(wpp);
+}
+
+/* Paste timer callback. */
+static void
+paste_send_timer(__unused int fd, __unused short events, void *arg)
+{
+	paste_send_next(arg);
+}
+
+/*
+ * Write as much as possible of the pastes waiting for a pane. Data is only
+ * written while the pane's output buffer is small, more is written from the
+ * pane's write callback as it drains. If paste-rate-limit is set, one
+ * tenth of the limit is written at a time with a timer in between.
+ */
+void
+paste_send_next(struct window_pane *wp)
+{
+	struct window_pane_paste	*wpp;
+	struct timeval			 tv = { .tv_usec = 100000 };
+	size_t				 max, limit;
+
+	if (event_initialized(&wp->paste_timer) &&
+	    evtimer_pending(&wp->paste_timer, NULL))
+		return;
+	if (wp->event == NULL || (wp->flags & PANE_INPUTOFF)) {
+		paste_cancel(wp);
+		return;
+	}
+
+	limit = options_get_number(global_options, "paste-rate-limit");
+	while ((wpp = TAILQ_FIRST(&wp->pastes)) != NULL) {
+		if (EVBUFFER_LENGTH(wp->event->output) >= PASTE_CHUNK_SIZE)
+			return;
+
+		max = PASTE_CHUNK_SIZE;
+		if (limit != 0 && limit / 10 < max)
+			max = (limit < 10) ? 1 : limit / 10;
+		paste_send_chunk(wp, wpp, max);
+		log_debug("%s: %%%u sent %zu of %zu", __func__, wp->id,
+		    wpp->offset, wpp->size);
+		if (wpp->offset == wpp->size)
+			paste_send_free(wp, wpp);
+
+		if (limit != 0 && !TAILQ_EMPTY(&wp->pastes)) {
+			evtimer_set(&wp->paste_timer, paste_send_timer, wp);
+			evtimer_add(&wp->paste_timer, &tv);
+			return;
+		}
+	}
+}
+
+/* Start pasting a buffer into a pane, after any pastes already waiting. */
+void
+paste_send(struct window_pane *wp, struct paste_buffer *pb,
+    const char *separator, int flags)
+{
+	struct window_pane_paste	*wpp;
+
+	wpp = xcalloc(1, sizeof *wpp);
+	wpp->pd = pb->pd;
+	wpp->pd->references++;
+	paste_total_size += pb->size;
+	wpp->size = pb->size;
+	wpp->separator = xstrdup(separator);
+	wpp->flags = flags;
+	TAILQ_INSERT_TAIL(&wp->pastes, wpp, entry);
+
+	paste_send_next(wp);
+}
+
+/*
+ * Write the rest of the pastes waiting for a pane at once, so that other input
+ * to the pane comes after them rather than in the middle.
+ */
+void
+paste_flush(struct window_pane *wp)
+{
+	struct window_pane_paste	*wpp;
+
+	if (TAILQ_EMPTY(&wp->pastes))
+		return;
+	if (wp->event == NULL || (wp->flags & PANE_INPUTOFF)) {
+		paste_cancel(wp);
+		return;
+	}
+
+	if (event_initialized(&wp->paste_timer))
+		evtimer_del(&wp->paste_timer);
+	while ((wpp = TAILQ_FIRST(&wp->pastes)) != NULL) {
+		log_debug("%s: %%%u at %zu of %zu", __func__, wp->id,
+		    wpp->offset, wpp->size);
+		paste_send_chunk(wp, wpp, wpp->size - wpp->offset);
+		paste_send_free(wp, wpp);
+	}
+}
+
+/* Cancel all pastes waiting for a pane. */
+void
+paste_cancel(struct window_pane *wp)
+{
+	struct window_pane_paste	*wpp, *wpp1;
+
+	if (event_initialized(&wp->paste_timer))
+		evtimer_del(&wp->paste_timer);
+	TAILQ_FOREACH_SAFE(wpp, &wp->pastes, entry, wpp1) {
+		log_debug("%s: %%%u at %zu of %zu", __func__, wp->id,
+		    wpp->offset, wpp->size);
+		if (wp->event != NULL && (wpp->flags & PASTE_BRACKETED))
+			bufferevent_write(wp->event, "\033[201~", 6);
+		paste_send_free(wp, wpp);
+	}
+}
+
+/* Get how much of the pastes waiting for a pane has been written. */
+void
+paste_progress(struct window_pane *wp, size_t *done, size_t *size)
+{
+	struct window_pane_paste	*wpp;
+
+	*done = *size = 0;
+	TAILQ_FOREACH(wpp, &wp->pastes, entry) {
+		*done += wpp->offset;
+		*size += wpp->size;
+	}
+}
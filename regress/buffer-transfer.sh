@@ -0,0 +1,47 @@
+#!/bin/sh
+
+# Check load-buffer and save-buffer move large files intact, both by path and
+# through standard input and output, and time them. The smaller file is read
+# and written directly by the server, the larger one is too big for that and
+# goes through the client.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+
+IN=$(mktemp)
+OUT=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; rm -f $IN $OUT" 0 1 15
+
+$TMUX -f/dev/null new -d 'sleep 100' || exit 1
+
+for size in 16 64; do
+	dd if=/dev/urandom of=$IN bs=1048576 count=$size 2>/dev/null || exit 1
+
+	rm -f $OUT
+	start=$(date +%s)
+	$TMUX loadb -b big $IN || exit 1
+	$TMUX saveb -b big $OUT || exit 1
+	end=$(date +%s)
+	cmp -s $IN $OUT || exit 1
+	echo "$size MiB by path: $((end - start)) seconds"
+
+	rm -f $OUT
+	start=$(date +%s)
+	$TMUX loadb -b big - <$IN || exit 1
+	$TMUX saveb -b big - >$OUT || exit 1
+	end=$(date +%s)
+	cmp -s $IN $OUT || exit 1
+	echo "$size MiB by standard input and output: $((end - start)) seconds"
+
+	$TMUX saveb -a -b big $OUT || exit 1
+	[ "$(wc -c <$OUT)" -eq $((size * 1048576 * 2)) ] || exit 1
+
+	cat $IN | $TMUX loadb -b big - || exit 1
+	$TMUX saveb -b big - | cmp -s $IN - || exit 1
+done
+
+exit 0
@@ -16,6 +16,7 @@
 #   -s custom separator, -d delete-after-paste, unknown buffer error;
 # - the buffer-limit option evicting the oldest automatic buffers but not
 #   named buffers;
+# - identical contents being shared and the buffer-memory-limit option;
 # - load-buffer/save-buffer round trips including control characters and
 #   UTF-8, save-buffer -a appending and errors for missing files/buffers.
 
@@ -176,6 +177,36 @@ check_ok set-option -g buffer-limit 50
 check_ok delete-buffer -b keepme
 check_ok delete-buffer; check_ok delete-buffer; check_ok delete-buffer
 
+# ---------------------------------------------------------------------------
+# buffer-memory-limit.
+
+# Identical contents are stored once and count once against the limit; when
+# it is exceeded the oldest automatic buffers go but the newest and named
+# buffers stay.
+check_ok set-buffer -b named 0123456789
+check_ok set-buffer 0123456789
+check_ok set-buffer 0123456789
+out=$($TMUX display -p '#{server_buffer_bytes} #{server_buffer_saved_bytes}')
+if [ "$out" != '10 20' ]; then
+	echo "shared buffer sizes wrong: '$out'"
+	exit 1
+fi
+check_ok set-option -s buffer-memory-limit 15
+check_ok set-buffer abcdefghij
+out=$(echo $($TMUX list-buffers -F '#{buffer_sample}'))
+if [ "$out" != 'abcdefghij 0123456789' ]; then
+	echo "buffer-memory-limit eviction wrong: '$out'"
+	exit 1
+fi
+check_ok set-option -s buffer-memory-limit 0
+check_ok delete-buffer -b named
+check_ok delete-buffer
+out=$($TMUX display -p '#{server_buffer_bytes} #{server_buffer_saved_bytes}')
+if [ "$out" != '0 0' ]; then
+	echo "buffer sizes not released: '$out'"
+	exit 1
+fi
+
 # ---------------------------------------------------------------------------
 # paste-buffer.
 
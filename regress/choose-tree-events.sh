@@ -0,0 +1,142 @@
+#!/bin/sh
+
+# Check choose-tree follows sessions, windows and panes being created, renamed,
+# removed, swapped and renumbered while it is open, that a filter is checked
+# again when the status line is redrawn, and time redrawing the status line
+# with a large tree open.
+#
+# As in choose-tree.sh, the tree is read by attaching a client from a second
+# server and capturing the pane it runs in.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -LtestB$$ -f/dev/null"
+$TMUX2 kill-server 2>/dev/null
+
+IN=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; $TMUX2 kill-server 2>/dev/null; rm -f $IN" 0 1 15
+
+# Wait for the tree to show, or with -v not show, some text.
+wait_for() {
+	n=0
+	while [ $n -lt 50 ]; do
+		if $TMUX2 capturep -p -t out: | grep -F -q "$2"; then
+			[ "$1" = "+" ] && return
+		else
+			[ "$1" = "-" ] && return
+		fi
+		sleep 0.2
+		n=$((n + 1))
+	done
+	exit 1
+}
+
+# Wait for a line in the tree to be followed by another.
+wait_for_next() {
+	n=0
+	while [ $n -lt 50 ]; do
+		$TMUX2 capturep -p -t out: | grep -F -A1 "$1" | grep -F -q "$2" &&
+			return
+		sleep 0.2
+		n=$((n + 1))
+	done
+	exit 1
+}
+
+$TMUX new -d -s zzz -x 80 -y 24 'cat' || exit 1
+$TMUX new -d -s aaa -x 80 -y 24 'cat' || exit 1
+$TMUX2 new -d -s out -x 80 -y 24 "$TMUX attach -t aaa" || exit 1
+n=0
+while [ "$($TMUX lsc | wc -l)" -ne 1 ]; do
+	[ $n -eq 50 ] && exit 1
+	sleep 0.2
+	n=$((n + 1))
+done
+
+$TMUX choose-tree -t aaa:0 \
+	-F '#{?pane_format,P=#{pane_title},#{?window_format,W=#{window_name},S}}' ||
+	exit 1
+wait_for + 'W=cat'
+
+# New, renamed and killed windows and panes.
+$TMUX neww -d -t zzz:5 -n new 'cat' || exit 1
+wait_for + 'W=new'
+$TMUX renamew -t zzz:5 renamed || exit 1
+wait_for + 'W=renamed'
+wait_for - 'W=new'
+$TMUX splitw -d -t zzz:5 'cat' || exit 1
+$TMUX selectp -t zzz:5.1 -T split || exit 1
+wait_for + 'P=split'
+$TMUX killp -t zzz:5.1 || exit 1
+wait_for - 'P=split'
+$TMUX killw -t zzz:5 || exit 1
+wait_for - 'W=renamed'
+
+# New, renamed and killed sessions.
+$TMUX new -d -s bbb 'cat' || exit 1
+wait_for + 'bbb: S'
+$TMUX rename -t bbb ccc || exit 1
+wait_for + 'ccc: S'
+wait_for - 'bbb: S'
+$TMUX kill-session -t ccc || exit 1
+wait_for - 'ccc: S'
+
+# Swapped and renumbered windows keep their panes.
+$TMUX neww -d -t zzz:3 -n one 'cat' || exit 1
+$TMUX selectp -t zzz:3.0 -T pone || exit 1
+$TMUX neww -d -t zzz:5 -n two 'cat' || exit 1
+$TMUX selectp -t zzz:5.0 -T ptwo || exit 1
+wait_for_next '3: W=one' 'P=pone'
+$TMUX swapw -d -s zzz:3 -t zzz:5 || exit 1
+wait_for_next '3: W=two' 'P=ptwo'
+wait_for_next '5: W=one' 'P=pone'
+$TMUX movew -r -t zzz || exit 1
+wait_for_next '1: W=two' 'P=ptwo'
+wait_for_next '2: W=one' 'P=pone'
+$TMUX killw -t zzz:1 \; killw -t zzz:2 || exit 1
+wait_for - 'W=one'
+
+# Changing the pane title is not an event the tree waits for but it is still
+# shown when the status line is redrawn.
+$TMUX selectp -t zzz:0.0 -T title || exit 1
+$TMUX refresh -S || exit 1
+wait_for + 'P=title'
+$TMUX send -t aaa:0 q || exit 1
+
+# A filter is checked again even without an event.
+$TMUX selectp -t zzz:0.0 -T keep1 || exit 1
+$TMUX choose-tree -t aaa:0 -f '#{m:keep*,#{pane_title}}' \
+	-F '#{?pane_format,P=#{pane_title},#{?window_format,W=#{window_name},S}}' ||
+	exit 1
+wait_for + 'P=keep1'
+wait_for - 'aaa: S'
+$TMUX selectp -t aaa:0.0 -T keep2 || exit 1
+$TMUX refresh -S || exit 1
+wait_for + 'P=keep2'
+$TMUX send -t aaa:0 q || exit 1
+
+# Time 500 status line redraws with choose-tree -G open on a group of 80
+# sessions with 50 windows each.
+awk 'BEGIN {
+	for (i = 1; i < 50; i++)
+		printf "neww -d -t aaa:%d \"sleep 100\"\n", i
+	for (i = 1; i < 80; i++)
+		printf "new -d -t aaa -s s%d\n", i
+}' >$IN
+$TMUX -C a -t aaa <$IN >/dev/null || exit 1
+$TMUX choose-tree -G -t aaa:0 || exit 1
+c=$($TMUX lsc -F '#{client_name}')
+awk -vc=$c 'BEGIN {
+	for (i = 0; i < 500; i++)
+		printf "refresh -S -t %s\n", c
+}' >$IN
+start=$(date +%s)
+$TMUX -C a -t zzz <$IN >/dev/null || exit 1
+end=$(date +%s)
+echo "500 redraws in $((end - start)) seconds"
+
+exit 0
@@ -0,0 +1,40 @@
+#!/bin/sh
+
+# Time opening and rebuilding choose-tree with thousands of windows.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+
+IN=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; rm -f $IN" 0 1 15
+
+# A group of 80 sessions with 50 windows each.
+$TMUX new -d -s s0 -x 200 -y 50 || exit 1
+awk 'BEGIN {
+	for (i = 1; i < 50; i++)
+		printf "neww -d -t s0:%d \"sleep 100\"\n", i
+	for (i = 1; i < 80; i++)
+		printf "new -d -t s0 -s s%d\n", i
+}' >$IN
+$TMUX -C a -t s0 <$IN >/dev/null || exit 1
+[ "$($TMUX lsw -a | wc -l)" -eq 4000 ] || exit 1
+
+# Open the tree with everything expanded, then reverse the sort order, which
+# builds it again, 50 times.
+awk 'BEGIN {
+	print "choose-tree -G -t s0:0"
+	print "send -t s0:0 M-+"
+	for (i = 0; i < 50; i++)
+		print "send -t s0:0 r"
+}' >$IN
+start=$(date +%s)
+$TMUX -C a -t s0 <$IN >/dev/null || exit 1
+end=$(date +%s)
+[ "$($TMUX display -p -t s0:0 '#{pane_mode}')" = "tree-mode" ] || exit 1
+echo "choose-tree built 52 times in $((end - start)) seconds"
+
+exit 0
@@ -0,0 +1,57 @@
+#!/bin/sh
+
+# Check repeated control mode command lines are kept parsed, that changing
+# command-alias empties the cache, that a failing kept command does not affect
+# the next identical line, and time a batch of repeated commands.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+IN=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; rm -f $TMP $IN" 0 1 15
+
+$TMUX new -d -x80 -y24 || exit 1
+
+# Repeated lines are only parsed once.
+awk 'BEGIN { for (i = 0; i < 100; i++) print "display -p hello" }' >$IN
+$TMUX -C a <$IN >$TMP || exit 1
+[ "$(grep -c '^hello$' $TMP)" = "100" ] || exit 1
+[ "$($TMUX display -p '#{server_control_parse_hits}')" -ge 99 ] || exit 1
+
+# A changed alias is seen by the next line.
+$TMUX set -s command-alias[100] foo='display -p one' || exit 1
+echo foo | $TMUX -C a >$TMP || exit 1
+grep -q '^one$' $TMP || exit 1
+$TMUX set -s command-alias[100] foo='display -p two' || exit 1
+echo foo | $TMUX -C a >$TMP || exit 1
+grep -q '^two$' $TMP || exit 1
+
+# Each of two identical failing lines gets its own error and the command after
+# the failure on each line is not run.
+cat <<EOF | $TMUX -C a >$TMP
+selectw -t:99 ; display -p after
+selectw -t:99 ; display -p after
+EOF
+[ "$(grep -c '^%error' $TMP)" = "2" ] || exit 1
+grep -q '^after$' $TMP && exit 1
+
+# Time a batch of repeated commands.
+awk 'BEGIN {
+	for (i = 0; i < 20000; i++) {
+		print "display -p -t:0 \"#{window_index}\""
+		print "refresh-client"
+		print "send-keys -H -t:0 20"
+	}
+}' >$IN
+start=$(date +%s)
+$TMUX -C a <$IN >$TMP || exit 1
+end=$(date +%s)
+[ "$(grep -c '^%end' $TMP)" -ge 60000 ] || exit 1
+echo "60000 commands in $((end - start)) seconds"
+
+exit 0
@@ -0,0 +1,73 @@
+#!/bin/sh
+
+# Check control mode request IDs are shown on guard lines, that requests which
+# only show information can complete out of order while an earlier request
+# waits, that commands for the same request stay in order, and time a batch of
+# requests.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+IN=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; rm -f $TMP $IN" 0 1 15
+
+$TMUX new -d -x80 -y24 || exit 1
+
+# The ID is added to the guard lines, and a bad ID is an error.
+(echo 'q1 display -p hello'; echo 'bad! display -p no'; sleep 1) |
+	$TMUX -C a -f request-ids >$TMP || exit 1
+grep -q '^%begin [0-9]* [0-9]* 1 q1$' $TMP || exit 1
+grep -q '^%end [0-9]* [0-9]* 1 q1$' $TMP || exit 1
+grep -q '^parse error: invalid request ID$' $TMP || exit 1
+grep -q '^no$' $TMP && exit 1
+
+# Other requests go ahead of a waiting one, but the rest of the waiting
+# request still runs after it.
+cat <<EOF >$IN
+w1 run-shell "sleep 1; echo slow"
+w1 display -p after-slow
+r1 display -p quick1
+r2 display -p quick2
+EOF
+(cat $IN; sleep 2) | $TMUX -C a -f request-ids >$TMP || exit 1
+grep -v '^%' $TMP >$IN
+cat <<EOF | cmp -s $IN - || exit 1
+quick1
+quick2
+slow
+after-slow
+EOF
+
+# A command which changes something does not go ahead of a waiting request,
+# and nor does anything after it.
+cat <<EOF >$IN
+w1 run-shell "sleep 1; echo slow"
+r1 display -p quick1
+r2 rename-window renamed
+r3 display -p '#{window_name}'
+EOF
+(cat $IN; sleep 2) | $TMUX -C a -f request-ids >$TMP || exit 1
+grep -v '^%' $TMP >$IN
+cat <<EOF | cmp -s $IN - || exit 1
+quick1
+slow
+renamed
+EOF
+
+# Time a batch of requests.
+awk 'BEGIN {
+	for (i = 0; i < 10000; i++)
+		printf "r%d list-panes -aF \"#{pane_id}\"\n", i
+}' >$IN
+start=$(date +%s)
+$TMUX -C a -f request-ids <$IN >$TMP || exit 1
+end=$(date +%s)
+[ "$(grep -c '^%end .* r[0-9]*$' $TMP)" = "10000" ] || exit 1
+echo "10000 requests in $((end - start)) seconds"
+
+exit 0
@@ -0,0 +1,65 @@
+#!/bin/sh
+
+# Check events in coalesce-events are fired once per target with the first
+# old values and the last new values, that other events and other targets are
+# not affected, that after- hooks are not kept, and time a burst of events with
+# a control client attached.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+IN=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; rm -f $TMP $IN" 0 1 15
+
+$TMUX new -d -x80 -y24 -n a || exit 1
+$TMUX neww -d -n z || exit 1
+$TMUX set-hook -g window-renamed \
+	'set -Fga @r "#{hook_old_name}>#{hook_new_name},"' || exit 1
+
+# Every event is fired without the option.
+$TMUX renamew -t:0 b \; renamew -t:0 c || exit 1
+sleep 1
+[ "$($TMUX show -gv @r)" = "a>b,b>c," ] || exit 1
+$TMUX set -gu @r || exit 1
+
+# With the option, one event for each window.
+$TMUX set -s coalesce-events[0] window-renamed || exit 1
+$TMUX renamew -t:0 d \; renamew -t:1 y \; renamew -t:0 e \; \
+	renamew -t:0 f || exit 1
+sleep 1
+[ "$($TMUX show -gv @r)" = "c>f,z>y," ] || exit 1
+[ "$($TMUX display -p '#{server_events_coalesced}')" -eq 2 ] || exit 1
+$TMUX set -gu @r || exit 1
+$TMUX set-hook -gu window-renamed || exit 1
+
+# An after- hook is fired straight away even if it is in the option.
+$TMUX set -s coalesce-events[1] after-rename-window || exit 1
+$TMUX set-hook -g after-rename-window 'set -ga @r x' || exit 1
+$TMUX renamew -t:0 g \; renamew -t:0 h || exit 1
+sleep 1
+[ "$($TMUX show -gv @r)" = "xx" ] || exit 1
+$TMUX set -gu @r || exit 1
+$TMUX set-hook -gu after-rename-window || exit 1
+
+# Time a burst of renames seen by a control client.
+awk 'BEGIN { for (i = 0; i < 2000; i++) printf "renamew -t:0 w%d\n", i }' >$IN
+(sleep 1; echo "source $IN"; echo "display -p done"; sleep 10) |
+	$TMUX -C a >$TMP &
+start=$(date +%s)
+n=0
+until grep -q '^done$' $TMP; do
+	n=$((n + 1))
+	[ $n -gt 300 ] && exit 1
+	sleep 0.1
+done
+end=$(date +%s)
+[ "$(grep -c '^%window-renamed @0 w1999$' $TMP)" -eq 1 ] || exit 1
+[ "$(grep -c '^%window-renamed' $TMP)" -lt 100 ] || exit 1
+echo "2000 events in $((end - start)) seconds"
+
+exit 0
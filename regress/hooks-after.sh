@@ -113,6 +113,23 @@ wait_for @safter 'after-rename-window:two'
 $TMUX set-hook -u -t two after-rename-window ||
 	fail "set-hook -u -t two failed"
 
+# An unset hook no longer fires, and a hook set only on a pane fires for
+# commands targeting that pane.
+$TMUX set -g @unset 0 || fail "set @unset failed"
+$TMUX set-hook -g after-resize-pane 'set -g @unset 1' ||
+	fail "set-hook -g after-resize-pane failed"
+$TMUX set-hook -gu after-resize-pane || fail "set-hook -gu resize failed"
+$TMUX resize-pane -t one:0 -Z || fail "resize-pane failed"
+assert_unchanged @unset 0
+$TMUX set -g @pafter 0 || fail "set @pafter failed"
+$TMUX set-hook -p -t two:0 after-resize-pane \
+	'set -gF @pafter "#{hook}:#{hook_flag_t}"' ||
+	fail "set-hook -p after-resize-pane failed"
+$TMUX resize-pane -t two:0 -Z || fail "resize-pane two failed"
+wait_for @pafter 'after-resize-pane:two:0'
+$TMUX set-hook -pu -t two:0 after-resize-pane ||
+	fail "set-hook -pu after-resize-pane failed"
+
 # The command-error hook fires when a command fails.
 $TMUX set -g @error 0 || fail "set @error failed"
 $TMUX set-hook -g command-error 'set -gF @error "#{hook}"' ||
@@ -0,0 +1,63 @@
+#!/bin/sh
+
+# Check shell commands in formats run by the job pool give the right output,
+# run in the right directory and report how they exited, that a command which
+# runs for too long is killed, and that making the pool smaller stops its idle
+# shells at once.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+OUT=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; rm -f $TMP $OUT" 0 1 15
+
+$TMUX new -d || exit 1
+$TMUX set -s job-pool-size 2 \; set -s job-pool-timeout 1 || exit 1
+
+# More commands than shells, one which fails and one which never finishes.
+# The format is expanded several times from one client so the results are
+# kept.
+F='#(echo hello)|#(pwd)|#(echo failed; exit 3)|#(sleep 100; echo never)'
+(
+	for i in 1 2 3 4; do
+		echo "display -p '$F'"
+		sleep 1.1
+	done
+	sleep 1.5
+	echo 'showmsgs -J'
+
+	# Two commands at once, then shrink the pool to nothing.
+	echo "display -p '#(sleep 0.5; echo a)#(sleep 0.5; echo b)'"
+	sleep 1
+	echo "display -p '#{job_pool_workers} #{job_pool_busy}'"
+	echo 'set -s job-pool-size 0'
+	echo "display -p '#{job_pool_workers} #{job_pool_busy}'"
+
+	# Commands still run without the pool.
+	echo "display -p '#(echo forked)'"
+	sleep 1.1
+	echo "display -p '#(echo forked)'"
+	sleep 0.5
+) | $TMUX -C a >$TMP || exit 1
+grep -v '^%' $TMP >$OUT
+
+# The last expansion has the output and the directory of the client.
+[ "$(grep '|' $OUT | tail -1 | cut -d'|' -f1-3)" = \
+    "hello|$(pwd -P)|failed" ] || exit 1
+
+# The exit status is kept, and the command which never finishes was killed.
+grep -q 'echo hello \[.*, exit 0' $OUT || exit 1
+grep -q 'exit 3 \[.*, exit 3' $OUT || exit 1
+grep -q 'sleep 100; echo never \[.*, signal 15' $OUT || exit 1
+
+# Both shells were idle and stopped as soon as the pool was made smaller.
+grep -qx '2 0' $OUT || exit 1
+grep -qx '0 0' $OUT || exit 1
+[ "$(tail -1 $OUT)" = "forked" ] || exit 1
+
+exit 0
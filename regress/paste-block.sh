@@ -0,0 +1,63 @@
+#!/bin/sh
+
+# Check text pasted into an attached client reaches the pane (and the other
+# panes with synchronize-panes) unchanged, that bound keys typed in a run of
+# text still run their binding, and time a large bracketed paste.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -LtestB$$ -f/dev/null"
+$TMUX2 kill-server 2>/dev/null
+
+IN=$(mktemp)
+OUT1=$(mktemp)
+OUT2=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; $TMUX2 kill-server 2>/dev/null; rm -f $IN $OUT1 $OUT2" 0 1 15
+
+# Wait for a file to be the given size.
+wait_size() {
+	n=0
+	while [ "$(wc -c <$1)" -lt $2 ]; do
+		n=$((n + 1))
+		[ $n -gt 300 ] && exit 1
+		sleep 0.1
+	done
+	[ "$(wc -c <$1)" -eq $2 ] || exit 1
+}
+
+$TMUX new -d -x80 -y24 "stty raw -echo; cat >>$OUT1" || exit 1
+$TMUX splitw -d "stty raw -echo; cat >>$OUT2" || exit 1
+$TMUX set -w synchronize-panes on || exit 1
+$TMUX bind -n '%' set -g @key yes || exit 1
+$TMUX2 new -d -x80 -y24 "$TMUX attach" || exit 1
+sleep 1
+
+# A run of text containing a bound key.
+$TMUX2 send -t:0 -l 'abc%def' || exit 1
+wait_size $OUT1 6
+[ "$(cat $OUT1)" = "abcdef" ] || exit 1
+[ "$($TMUX show -gv @key)" = "yes" ] || exit 1
+: >$OUT1
+: >$OUT2
+
+# A bracketed paste of about 1 MB.
+awk 'BEGIN {
+	for (i = 0; i < 16384; i++)
+		printf "%08d %%abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMN\n", i
+}' >$IN
+size=$(wc -c <$IN)
+$TMUX2 loadb $IN || exit 1
+start=$(date +%s)
+$TMUX2 pasteb -pr -t:0 || exit 1
+wait_size $OUT1 $size
+end=$(date +%s)
+wait_size $OUT2 $size
+cmp -s $IN $OUT1 || exit 1
+cmp -s $IN $OUT2 || exit 1
+echo "$size bytes pasted in $((end - start)) seconds"
+
+exit 0
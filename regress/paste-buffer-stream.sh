@@ -0,0 +1,57 @@
+#!/bin/sh
+
+# Check large buffers are pasted intact a piece at a time, that
+# paste-rate-limit slows them down, that paste-buffer -c cancels them and
+# that keys sent during a paste come after it.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+
+IN=$(mktemp)
+OUT=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; rm -f $IN $OUT" 0 1 15
+
+$TMUX -f/dev/null new -d "stty raw -echo; cat >>$OUT" || exit 1
+sleep 0.5
+
+awk 'BEGIN { for (i = 0; i < 20000; i++) printf "line %d of the buffer\n", i }' \
+	>$IN
+$TMUX loadb $IN || exit 1
+
+# With -r the buffer goes through unchanged.
+$TMUX pasteb -r || exit 1
+n=0
+while [ "$($TMUX display -p '#{pane_pasting}')" = "1" ]; do
+	n=$((n + 1))
+	[ $n -gt 50 ] && exit 1
+	sleep 0.1
+done
+sleep 0.5
+cmp -s $IN $OUT || exit 1
+
+# A limited paste is still in progress after a second and stops when
+# cancelled.
+: >$OUT
+$TMUX set -s paste-rate-limit 50000 || exit 1
+$TMUX pasteb -r || exit 1
+sleep 1
+[ "$($TMUX display -p '#{pane_pasting}')" = "1" ] || exit 1
+[ "$($TMUX display -p '#{pane_paste_progress}')" -lt 50 ] || exit 1
+$TMUX pasteb -c || exit 1
+[ "$($TMUX display -p '#{pane_pasting}')" = "0" ] || exit 1
+sleep 0.5
+[ "$(wc -c <$OUT)" -lt "$(wc -c <$IN)" ] || exit 1
+
+# Keys sent while a limited paste is in progress write the rest of the
+# paste first.
+: >$OUT
+$TMUX pasteb -r \; send-keys -l END || exit 1
+[ "$($TMUX display -p '#{pane_pasting}')" = "0" ] || exit 1
+sleep 1
+(cat $IN; printf END) | cmp -s - $OUT || exit 1
+
+exit 0
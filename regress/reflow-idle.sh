@@ -0,0 +1,59 @@
+#!/bin/sh
+
+# Check history left to be reflowed after a resize is reflowed in the
+# background and is the same as if it had been reflowed at once.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+
+TMP1=$(mktemp)
+TMP2=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; rm -f $TMP1 $TMP2" 0 1 15
+
+$TMUX start \; set -g history-limit 200000 \; \
+	new -d -x 80 -y 24 || exit 1
+$TMUX set -g window-size manual || exit 1
+for i in 1 2 3; do
+	$TMUX neww -d -t :$i "seq -f '%0150.0f' 1 100000; cat" || exit 1
+done
+$TMUX respawnw -k -t :0 "awk 'BEGIN {
+	for (i = 0; i < 50000; i++)
+		printf \"%d %0*d\\n\", i, i % 200, 0
+}'; cat" || exit 1
+n=0
+while [ $n -lt 100 ]; do
+	out=$($TMUX lsw -F '#{window_index} #{history_size}' |
+		awk '$1 != 0 && $2 < 99000' | wc -l)
+	[ $out -eq 0 ] && $TMUX capturep -pJ -t :0 | grep -q '^49999 ' && break
+	sleep 0.1
+	n=$((n + 1))
+done
+[ $n -eq 100 ] && exit 1
+$TMUX capturep -pJ -t :0 -S - >$TMP1 || exit 1
+
+# Resize every window and wait for the history to be reflowed.
+start=$(date +%s)
+for i in 0 1 2 3; do
+	$TMUX resizew -t :$i -x 57 || exit 1
+done
+[ "$($TMUX display -p '#{server_reflow_pending}')" -gt 0 ] || exit 1
+n=0
+while [ $n -lt 300 ]; do
+	[ "$($TMUX display -p '#{server_reflow_pending}')" -eq 0 ] && break
+	sleep 0.1
+	n=$((n + 1))
+done
+[ $n -eq 300 ] && exit 1
+end=$(date +%s)
+echo "history reflowed in $((end - start)) seconds"
+
+$TMUX capturep -pJ -t :0 -S - >$TMP2 || exit 1
+cmp -s $TMP1 $TMP2 || exit 1
+[ "$($TMUX capturep -p -t :0 -S 0 -E 0 | awk '{ print length }')" -le 57 ] ||
+	exit 1
+
+exit 0
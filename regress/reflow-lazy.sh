@@ -0,0 +1,85 @@
+#!/bin/sh
+
+# Check history left to be reflowed after a resize is the same as if it had
+# been reflowed at once when it is captured, copied or scrolled into view, and
+# time resizing a pane with a large history.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+
+TMP1=$(mktemp)
+TMP2=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; rm -f $TMP1 $TMP2" 0 1 15
+
+# Wait for the pane to have the given amount of history and line of output.
+wait_history() {
+	n=0
+	while [ $n -lt 100 ]; do
+		[ "$($TMUX display -p '#{history_size}')" -ge $1 ] &&
+			$TMUX capturep -pJ | grep -q "^$2" && return
+		sleep 0.1
+		n=$((n + 1))
+	done
+	exit 1
+}
+
+$TMUX start \; set -g history-limit 200000 \; \
+	new -d -x 80 -y 24 || exit 1
+$TMUX set -g window-size manual || exit 1
+$TMUX respawnw -k "awk 'BEGIN {
+	for (i = 0; i < 20000; i++)
+		printf \"%d %0*d\\n\", i, i % 200, 0
+}'; cat" || exit 1
+wait_history 30000 '19999 '
+$TMUX capturep -pJ -S - >$TMP1 || exit 1
+
+# Captures of the whole history are the same after resizing.
+for i in 40 133 57 200 80; do
+	$TMUX resizew -x $i || exit 1
+	$TMUX capturep -pJ -S - >$TMP2 || exit 1
+	cmp -s $TMP1 $TMP2 || exit 1
+done
+
+# And the end of the history.
+$TMUX resizew -x 50 || exit 1
+$TMUX capturep -pJ -S -100 >$TMP2 || exit 1
+n=$(($(wc -l <$TMP2) - 1))
+[ "$(tail -n $n $TMP2)" = "$(tail -n $n $TMP1)" ] || exit 1
+$TMUX resizew -x 80 || exit 1
+
+# Copy mode sees the whole history.
+$TMUX resizew -x 41 || exit 1
+$TMUX copy-mode \; send -X history-top || exit 1
+[ "$($TMUX display -p '#{copy_cursor_line}')" = "0 0" ] || exit 1
+$TMUX send -X cancel || exit 1
+
+# Growing the pane pulls lines back from the history.
+$TMUX resizew -x 80 -y 10 || exit 1
+$TMUX resizew -x 30 || exit 1
+$TMUX resizew -y 5000 || exit 1
+$TMUX resizew -x 80 -y 24 || exit 1
+$TMUX capturep -pJ -S - >$TMP2 || exit 1
+cmp -s $TMP1 $TMP2 || exit 1
+$TMUX kill-server
+
+# Time resizing a pane with 200000 lines of history.
+TMUX="$TEST_TMUX -LtestB$$ -f/dev/null"
+trap "$TMUX kill-server 2>/dev/null; rm -f $TMP1 $TMP2" 0 1 15
+$TMUX start \; set -g history-limit 200000 \; \
+	new -d -x 80 -y 24 "seq -f '%0150.0f' 1 200000; cat" || exit 1
+$TMUX set -g window-size manual || exit 1
+wait_history 190000 '0*200000$'
+start=$(date +%s)
+i=0
+while [ $i -lt 100 ]; do
+	echo "resizew -x $((60 + i % 2 * 40))"
+	i=$((i + 1))
+done | $TMUX -C a >/dev/null || exit 1
+end=$(date +%s)
+echo "100 resizes in $((end - start)) seconds"
+
+exit 0
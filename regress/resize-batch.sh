@@ -0,0 +1,70 @@
+#!/bin/sh
+
+# Check windows end up at the right size when many clients attach at once
+# and print how many times they were resized on the way. Then check a single
+# change which resizes several windows is applied to all of them at once.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -LtestB$$ -f/dev/null"
+$TMUX2 kill-server 2>/dev/null
+
+trap "$TMUX kill-server 2>/dev/null; $TMUX2 kill-server 2>/dev/null" 0 1 15
+
+# Four sessions, each with one window.
+$TMUX2 start \; set -g history-limit 50000 \; \
+	new -d -s t0 -x 300 -y 60 'seq 1 50000; cat' \; \
+	new -d -s t1 -x 300 -y 60 'cat' \; \
+	new -d -s t2 -x 300 -y 60 'cat' \; \
+	new -d -s t3 -x 300 -y 60 'cat' || exit 1
+$TMUX2 set -g window-size smallest || exit 1
+$TMUX2 set -g @resized 0 || exit 1
+$TMUX2 set-hook -g window-resized 'set -gF @resized "#{e|+:#{@resized},1}"' ||
+	exit 1
+sleep 1
+
+# Check each window has the given size, waiting a little if needed.
+check() {
+	n=0
+	while [ $n -lt 20 ]; do
+		[ "$($TMUX2 lsw -a -F '#{window_width}x#{window_height}' |
+		    tr '\n' ' ')" = "$1" ] && return
+		sleep 0.1
+		n=$((n + 1))
+	done
+	exit 1
+}
+
+# Attach 20 clients, each smaller than the last, spread over the sessions.
+i=0
+while [ $i -lt 20 ]; do
+	$TMUX new -d -x $((200 - i)) -y 40 "$TMUX2 attach -t t$((i % 4))" ||
+		exit 1
+	i=$((i + 1))
+done
+n=0
+while [ $n -lt 50 ]; do
+	[ "$($TMUX2 lsc | wc -l)" -eq 20 ] && break
+	sleep 0.1
+	n=$((n + 1))
+done
+[ $n -eq 50 ] && exit 1
+
+# Each window should end up the size of the smallest client looking at it.
+check "184x39 183x39 182x39 181x39 "
+
+$TMUX2 display -p \
+	'#{@resized} resizes, #{server_resizes_avoided} avoided'
+
+# After a pause, a change which resizes every window is not delayed, so all
+# the windows have their new size by the time the next command runs.
+sleep 1
+$TMUX2 set -g window-size largest || exit 1
+[ "$($TMUX2 lsw -a -F '#{window_width}x#{window_height}' | tr '\n' ' ')" = \
+    "200x39 199x39 198x39 197x39 " ] || exit 1
+
+exit 0
@@ -0,0 +1,99 @@
+#!/bin/sh
+
+# Check windows are sized only by clients attached to sessions containing
+# them, including windows linked into several sessions, and time resizing
+# clients on a server with many windows and clients.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+
+IN=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; rm -f $IN" 0 1 15
+
+# Attach a control client to a session with the given size and wait for it.
+attach() {
+	(echo "refresh -C $2"; sleep 10) | $TMUX -C a -t $1 >/dev/null &
+	n=0
+	while [ $n -lt 20 ]; do
+		[ "$($TMUX lsc -t $1 | wc -l)" -ge $3 ] && return
+		sleep 0.1
+		n=$((n + 1))
+	done
+	exit 1
+}
+
+# Check the size of a window, waiting for any resize.
+check_size() {
+	n=0
+	while [ $n -lt 20 ]; do
+		out=$($TMUX display -p -t $1 '#{window_width}x#{window_height}')
+		[ "$out" = "$2" ] && return
+		sleep 0.1
+		n=$((n + 1))
+	done
+	exit 1
+}
+
+$TMUX new -d -s s1 -x 100 -y 40 || exit 1
+$TMUX neww -d -t s1:1 || exit 1
+$TMUX new -d -s s2 -x 100 -y 40 || exit 1
+$TMUX linkw -s s1:1 -t s2:1 || exit 1
+$TMUX set -g window-size smallest || exit 1
+
+attach s1 60x20 1
+attach s2 50x30 1
+check_size s1:0 60x20
+check_size s2:1 50x20
+
+# A second client on the same session.
+attach s2 70x15 2
+check_size s2:1 50x15
+check_size s1:0 60x20
+
+# Largest.
+$TMUX set -g window-size largest || exit 1
+check_size s1:0 60x20
+check_size s2:1 70x30
+
+# Unlinking the window leaves it sized by the first session only.
+$TMUX unlinkw -t s2:1 || exit 1
+$TMUX selectw -t s1:1 || exit 1
+check_size s1:1 60x20
+check_size s2:0 70x30
+$TMUX kill-server
+
+# Time selecting windows, which recalculates the size of every window, with 20
+# sessions of 50 windows and 20 clients.
+TMUX="$TEST_TMUX -LtestB$$ -f/dev/null"
+trap "$TMUX kill-server 2>/dev/null; rm -f $IN" 0 1 15
+$TMUX new -d -s s0 -x 80 -y 24 || exit 1
+awk 'BEGIN {
+	for (i = 0; i < 20; i++) {
+		if (i != 0)
+			printf "new -d -s s%d -x 80 -y 24\n", i
+		for (j = 1; j < 50; j++)
+			printf "neww -d -t s%d:%d \"sleep 100\"\n", i, j
+	}
+}' >$IN
+$TMUX -C a -t s0 <$IN >/dev/null || exit 1
+i=0
+while [ $i -lt 20 ]; do
+	attach s$i 80x24 1
+	i=$((i + 1))
+done
+awk 'BEGIN {
+	for (i = 0; i < 2000; i++)
+		printf "selectw -t s0:%d\n", i % 50
+}' >$IN
+start=$(date +%s)
+$TMUX -C a -t s0 <$IN >/dev/null || exit 1
+end=$(date +%s)
+echo "2000 windows selected in $((end - start)) seconds"
+$TMUX display -p \
+	'#{server_size_recalculations} in #{server_size_recalculation_time} us'
+
+exit 0
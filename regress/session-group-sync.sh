@@ -0,0 +1,102 @@
+#!/bin/sh
+
+# Check grouped sessions keep the same windows, their own current and last
+# windows, and their alerts across new-window, kill-window, move-window and
+# swap-window, and time new-window in a large group.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+
+trap "$TMUX kill-server 2>/dev/null" 0 1 15
+
+# Check every session in the group has the given windows.
+check_windows() {
+	for i in g0 g1 g2; do
+		out=$(echo $($TMUX lsw -t $i -F '#{window_index}:#{window_name}'))
+		[ "$out" = "$1" ] || exit 1
+	done
+}
+
+# Check the current and last window of a session.
+check_current() {
+	out=$($TMUX lsw -t $1 -F '#{window_index}#{?window_active,*,}#{?window_last_flag,-,}')
+	[ "$(echo $out)" = "$2" ] || exit 1
+}
+
+$TMUX new -d -s g0 -n a || exit 1
+$TMUX neww -d -t g0:1 -n b || exit 1
+$TMUX neww -d -t g0:2 -n c || exit 1
+$TMUX new -d -t g0 -s g1 || exit 1
+$TMUX new -d -t g0 -s g2 || exit 1
+check_windows '0:a 1:b 2:c'
+
+# Each session keeps its own current and last window.
+$TMUX selectw -t g1:2 || exit 1
+$TMUX selectw -t g1:1 || exit 1
+$TMUX selectw -t g2:2 || exit 1
+check_current g1 '0 1* 2-'
+check_current g2 '0- 1 2*'
+
+# New windows appear everywhere without changing other sessions.
+$TMUX neww -d -t g0:5 -n d || exit 1
+check_windows '0:a 1:b 2:c 5:d'
+check_current g1 '0 1* 2- 5'
+check_current g2 '0- 1 2* 5'
+
+# Killing the current window moves to another one in every session.
+$TMUX killw -t g0:2 || exit 1
+check_windows '0:a 1:b 5:d'
+check_current g1 '0- 1* 5'
+check_current g2 '0* 1 5'
+
+# Moving the current window away moves to the last window.
+$TMUX selectw -t g1:5 || exit 1
+$TMUX movew -s g0:5 -t g0:7 || exit 1
+check_windows '0:a 1:b 7:d'
+check_current g1 '0- 1* 7'
+check_current g2 '0* 1 7'
+
+# Swapping two windows.
+$TMUX swapw -d -s g0:0 -t g0:1 || exit 1
+check_windows '0:b 1:a 7:d'
+check_current g1 '0- 1* 7'
+
+# Alerts are shared.
+$TMUX set -g monitor-bell on || exit 1
+$TMUX respawnw -k -t g0:0 "printf '\\a'; sleep 100" || exit 1
+sleep 1
+$TMUX neww -d -t g0:9 || exit 1
+for i in g0 g1 g2; do
+	[ "$($TMUX display -p -t $i:0 '#{window_bell_flag}')" = "1" ] || exit 1
+done
+$TMUX kill-server
+
+# Time new-window in a group of 30 sessions with 80 windows each.
+$TMUX new -d -s g0 || exit 1
+i=1
+while [ $i -lt 80 ]; do
+	echo "neww -d -t g0:$i 'sleep 100'"
+	i=$((i + 1))
+done | $TMUX -C a -t g0 >/dev/null || exit 1
+i=1
+while [ $i -lt 30 ]; do
+	echo "new -d -t g0 -s g$i"
+	i=$((i + 1))
+done | $TMUX -C a -t g0 >/dev/null || exit 1
+[ "$($TMUX lsw -t g29 | wc -l)" -eq 80 ] || exit 1
+start=$(date +%s)
+i=0
+while [ $i -lt 200 ]; do
+	echo "neww -d -t g0:$((100 + i)) 'sleep 100'"
+	echo "killw -t g0:$((100 + i))"
+	i=$((i + 1))
+done | $TMUX -C a -t g0 >/dev/null || exit 1
+end=$(date +%s)
+[ "$($TMUX lsw -t g29 | wc -l)" -eq 80 ] || exit 1
+echo "200 windows in $((end - start)) seconds"
+
+exit 0
@@ -0,0 +1,67 @@
+#!/bin/sh
+
+# Check SIXEL images are parsed to the right size and time parsing a small
+# corpus of images: tools/image.sixel and a generated plot-like image made
+# mostly of long repeated runs.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+
+TMP=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; rm -f $TMP" 0 1 15
+
+$TMUX -f/dev/null new -d -x 200 -y 100 'sleep 100' || exit 1
+[ "$($TMUX display -p '#{sixel_support}')" = "1" ] || exit 0
+
+awk 'BEGIN {
+	printf "\033Pq\"1;1;1200;600#0;2;100;100;100#1;2;0;0;100"
+	for (i = 0; i < 100; i++)
+		printf "#0!1200~$#1!%d?!50@-", 1 + (i * 11) % 1100
+	printf "\033\\"
+}' >$TMP
+
+# Parse the image the given number of times and check the cursor is left
+# below it.
+parse() {
+	$TMUX respawnp -k "i=0; while [ \$i -lt $2 ]; do cat $1; i=\$((i+1)); done; $TMUX wait -S sixel; sleep 100" || exit 1
+	$TMUX wait sixel
+	[ "$($TMUX display -p '#{pane_images}')" -ge 1 ] || exit 1
+}
+
+parse ../tools/image.sixel 1
+[ "$($TMUX display -p '#{cursor_y}')" = "11" ] || exit 1
+parse $TMP 1
+[ "$($TMUX display -p '#{cursor_y}')" = "19" ] || exit 1
+
+# An image with a raster size over the limit is ignored.
+printf '\033Pq"1;1;99999;9999#0~\033\\' >$TMP.big
+$TMUX respawnp -k "cat $TMP.big; $TMUX wait -S sixel; sleep 100" || exit 1
+$TMUX wait sixel
+rm -f $TMP.big
+[ "$($TMUX display -p '#{pane_images}')" = "0" ] || exit 1
+
+# An image whose position wraps past the largest width is ignored.
+$TMUX set -s input-buffer-size 4194304 || exit 1
+awk 'BEGIN {
+	printf "\033Pq#0~"
+	for (i = 0; i < 429496; i++)
+		printf "!10000?"
+	printf "!7290?!10~\033\\"
+}' >$TMP.big
+$TMUX respawnp -k "cat $TMP.big; $TMUX wait -S sixel; sleep 100" || exit 1
+$TMUX wait sixel
+rm -f $TMP.big
+[ "$($TMUX display -p '#{pane_images}')" = "0" ] || exit 1
+
+for i in ../tools/image.sixel $TMP; do
+	start=$(date +%s)
+	parse $i 50
+	end=$(date +%s)
+	echo "$i: 50 images in $((end - start)) seconds"
+done
+
+exit 0
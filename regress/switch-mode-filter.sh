@@ -0,0 +1,107 @@
+#!/bin/sh
+
+# Check switch-mode shows the same windows as the fuzzy format when the filter
+# is typed one key at a time, including filters that cannot be narrowed from
+# the last matches, and time typing a filter with many windows.
+#
+# As in choose-tree.sh, the list is read by attaching a client from a second
+# server and capturing the pane it runs in.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -LtestB$$ -f/dev/null"
+$TMUX2 kill-server 2>/dev/null
+
+IN=$(mktemp)
+trap "$TMUX kill-server 2>/dev/null; $TMUX2 kill-server 2>/dev/null; rm -f $IN" 0 1 15
+
+# Attach a client from the second server and wait for it.
+attach() {
+	$TMUX2 new -d -s out -x 80 -y 30 "$TMUX attach -t t" || exit 1
+	n=0
+	while [ "$($TMUX lsc | wc -l)" -ne 1 ]; do
+		[ $n -eq 50 ] && exit 1
+		sleep 0.2
+		n=$((n + 1))
+	done
+}
+
+# Type a filter and compare the windows shown with those the format matches.
+check() {
+	$TMUX switch-mode -w -F '#{window_name}' -t t:0 || exit 1
+	$TMUX send -t t:0 -l "$1" || exit 1
+	[ -n "$2" ] && { $TMUX send -t t:0 $2 || exit 1; }
+	exp=$($TMUX lsw -t t -F "#{?#{m/z:$3,#{window_name}},#{window_name},}" |
+		sed '/^$/d' | sort)
+	n=0
+	while [ $n -lt 50 ]; do
+		out=$($TMUX2 capturep -p -t out: | sed '/(search)/d; /^ *$/d' |
+			sed 's/ *$//' | sort)
+		[ "$out" = "$exp" ] && break
+		sleep 0.2
+		n=$((n + 1))
+	done
+	$TMUX send -t t:0 Escape || exit 1
+	if [ "$out" != "$exp" ]; then
+		echo "Filter '$1' $2 failed."
+		echo "Expected: $exp"
+		echo "But got:  $out"
+		exit 1
+	fi
+}
+
+$TMUX new -d -s t -x 80 -y 30 -n alpha cat || exit 1
+for i in alphabet beta abc cab Abc 'ab$c' bxa 'a b' 'FOO barX'; do
+	$TMUX neww -d -t t -n "$i" cat || exit 1
+done
+$TMUX set -g status off || exit 1
+attach
+
+check 'ab' '' 'ab'
+check 'abc' '' 'abc'
+check 'Ab' '' 'Ab'
+check '!a' '' '!a'
+check '!ab' '' '!ab'
+check "'" '' "'"
+check "'bc" '' "'bc"
+check 'a|' '' 'a|'
+check 'a|b' '' 'a|b'
+check 'ab$' '' 'ab$'
+check 'ab$c' '' 'ab$c'
+check 'a b' '' 'a b'
+check 'a !b' '' 'a !b'
+check '!foo barX' '' '!foo barX'
+check 'abc' 'BSpace' 'ab'
+check 'ab' 'BSpace' 'a'
+
+# Time typing a filter in switch-mode with a group of 80 sessions with 50
+# windows each.
+$TMUX2 kill-server
+$TMUX kill-server
+TMUX="$TEST_TMUX -LtestC$$ -f/dev/null"
+TMUX2="$TEST_TMUX -LtestD$$ -f/dev/null"
+trap "$TMUX kill-server 2>/dev/null; $TMUX2 kill-server 2>/dev/null; rm -f $IN" 0 1 15
+$TMUX new -d -s t -x 200 -y 50 || exit 1
+awk 'BEGIN {
+	for (i = 1; i < 50; i++)
+		printf "neww -d -t t:%d \"sleep 100\"\n", i
+	for (i = 1; i < 80; i++)
+		printf "new -d -t t -s s%d\n", i
+}' >$IN
+$TMUX -C a -t t <$IN >/dev/null || exit 1
+attach
+$TMUX switch-mode -w -t t:0 || exit 1
+start=$(date +%s)
+for i in 1 2 3 4 5 6 7 8 9 10; do
+	for c in s 1 : 2 BSpace BSpace BSpace BSpace; do
+		$TMUX send -t t:0 $c || exit 1
+	done
+done
+end=$(date +%s)
+echo "80 keys typed in $((end - start)) seconds"
+
+exit 0
@@ -0,0 +1,48 @@
+#!/bin/sh
+
+# Check clients with the same terminal share a key tree, that keys are still
+# found in it, and that changing user-keys builds a new tree.
+
+PATH=/bin:/usr/bin
+TERM=screen
+
+[ -z "$TEST_TMUX" ] && TEST_TMUX=$(readlink -f ../tmux)
+TMUX="$TEST_TMUX -LtestA$$ -f/dev/null"
+$TMUX kill-server 2>/dev/null
+TMUX2="$TEST_TMUX -LtestB$$ -f/dev/null"
+$TMUX2 kill-server 2>/dev/null
+
+trap "$TMUX kill-server 2>/dev/null; $TMUX2 kill-server 2>/dev/null" 0 1 15
+
+$TMUX new -d -x80 -y24 || exit 1
+$TMUX bind -n F2 set -g @key F2 || exit 1
+$TMUX bind -n C-Left set -g @key C-Left || exit 1
+
+# Attach several clients from panes in another server.
+$TMUX2 new -d -x80 -y24 "$TMUX attach" || exit 1
+for i in 1 2 3; do
+	$TMUX2 neww -d "$TMUX attach" || exit 1
+done
+sleep 1
+[ "$($TMUX list-clients | wc -l)" -eq 4 ] || exit 1
+[ "$($TMUX display -p '#{server_key_trees}')" = "1" ] || exit 1
+
+# Keys are found.
+for i in F2 C-Left; do
+	$TMUX2 send -t:0 $i || exit 1
+	sleep 1
+	[ "$($TMUX show -gv @key)" = "$i" ] || exit 1
+done
+
+# Attaching again uses the same tree, changing user-keys builds another.
+$TMUX2 neww -d "$TMUX attach" || exit 1
+sleep 1
+[ "$($TMUX display -p '#{server_key_trees}')" = "1" ] || exit 1
+$TMUX set -s user-keys[0] "$(printf '\033[99~')" || exit 1
+$TMUX bind -n User0 set -g @key User0 || exit 1
+[ "$($TMUX display -p '#{server_key_trees}')" = "2" ] || exit 1
+$TMUX2 send -t:0 -l "$(printf '\033[99~')" || exit 1
+sleep 1
+[ "$($TMUX show -gv @key)" = "User0" ] || exit 1
+
+exit 0
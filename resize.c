@@ -17,11 +17,41 @@
  */
 
 #include <sys/types.h>
+#include <sys/time.h>
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "tmux.h"
 
+/* Options read for every window when recalculating sizes. */
+static struct options_handle oh_window_size =
+    OPTIONS_HANDLE("window-size");
+static struct options_handle oh_aggressive_resize =
+    OPTIONS_HANDLE("aggressive-resize");
+
+/* Clients which may affect the size of the window being calculated. */
+static struct client	**resize_clients;
+static u_int		  resize_nclients;
+static u_int		  resize_size;
+
+/* Number of and total time in microseconds of size recalculations. */
+static u_int		  resize_count;
+static uint64_t		  resize_time;
+
+/*
+ * When windows need to be resized again soon after the last resize (such as
+ * when many clients attach or change size at once), wait until there have been
+ * no new sizes for RESIZE_DELAY milliseconds (but no longer than
+ * RESIZE_MAXIMUM_DELAY) so each window is only resized once to its final size.
+ */
+#define RESIZE_DELAY 50
+#define RESIZE_MAXIMUM_DELAY 250
+static struct event	  resize_timer;
+static uint64_t		  resize_last;
+static uint64_t		  resize_start;
+static u_int		  resize_avoided;
+
 static void
 resize_fire_window_resized(struct window *w, u_int old_sx, u_int old_sy)
 {
@@ -83,6 +113,62 @@ resize_window(struct window *w, u_int sx, u_int sy, int xpixel, int ypixel)
 	w->flags &= ~WINDOW_RESIZE;
 }
 
+/* Resize timer event. */
+static void
+resize_timer_callback(__unused int fd, __unused short events,
+    __unused void *data)
+{
+	log_debug("%s: resize timer expired", __func__);
+	evtimer_del(&resize_timer);
+}
+
+/* Windows have a new size to be applied later, so decide when. */
+static void
+resize_delay(void)
+{
+	struct timeval	tv = { 0 };
+	uint64_t	t = get_timer(), delay;
+
+	if (!event_initialized(&resize_timer))
+		evtimer_set(&resize_timer, resize_timer_callback, NULL);
+	if (!evtimer_pending(&resize_timer, NULL)) {
+		if (t - resize_last >= RESIZE_DELAY) {
+			resize_last = t;
+			return;
+		}
+		resize_start = t;
+	}
+	resize_last = t;
+
+	if (t >= resize_start + RESIZE_MAXIMUM_DELAY)
+		return;
+	delay = resize_start + RESIZE_MAXIMUM_DELAY - t;
+	if (delay > RESIZE_DELAY)
+		delay = RESIZE_DELAY;
+	log_debug("%s: delaying resize for %llu milliseconds", __func__,
+	    (unsigned long long)delay);
+
+	tv.tv_usec = delay * 1000;
+	evtimer_del(&resize_timer);
+	evtimer_add(&resize_timer, &tv);
+}
+
+/* Are window resizes being delayed? */
+int
+resize_is_delayed(void)
+{
+	if (!event_initialized(&resize_timer))
+		return (0);
+	return (evtimer_pending(&resize_timer, NULL));
+}
+
+/* Get number of window resizes replaced by a later size. */
+u_int
+resize_avoided_count(void)
+{
+	return (resize_avoided);
+}
+
 static int
 ignore_client_size(struct client *c)
 {
@@ -113,13 +199,65 @@ ignore_client_size(struct client *c)
 	return (0);
 }
 
+static void
+clients_add(struct client *c)
+{
+	if (resize_nclients == resize_size) {
+		resize_clients = xreallocarray(resize_clients,
+		    resize_size + 8, sizeof *resize_clients);
+		resize_size += 8;
+	}
+	resize_clients[resize_nclients++] = c;
+}
+
+/*
+ * Build the list of clients which may affect the size: the given client and
+ * the clients attached to sessions containing the window, or to the session
+ * if there is no window. This means only clients which are looking at the
+ * window are checked rather than every client.
+ */
+static void
+clients_for_window(struct client *c, struct session *s, struct window *w)
+{
+	struct winlink	*wl, *loop;
+	struct client	*cloop;
+
+	resize_nclients = 0;
+	if (c != NULL)
+		clients_add(c);
+
+	if (w == NULL) {
+		if (s != NULL) {
+			TAILQ_FOREACH(cloop, &s->clients, sentry) {
+				if (cloop != c)
+					clients_add(cloop);
+			}
+		}
+		return;
+	}
+	TAILQ_FOREACH(wl, &w->winlinks, wentry) {
+		/* Only look at each session once. */
+		TAILQ_FOREACH(loop, &w->winlinks, wentry) {
+			if (loop == wl || loop->session == wl->session)
+				break;
+		}
+		if (loop != wl)
+			continue;
+		TAILQ_FOREACH(cloop, &wl->session->clients, sentry) {
+			if (cloop != c)
+				clients_add(cloop);
+		}
+	}
+}
+
 static u_int
 clients_with_window(struct window *w)
 {
 	struct client	*loop;
-	u_int		 n = 0;
+	u_int		 i, n = 0;
 
-	TAILQ_FOREACH(loop, &clients, entry) {
+	for (i = 0; i < resize_nclients; i++) {
+		loop = resize_clients[i];
 		if (ignore_client_size(loop) || !session_has(loop->session, w))
 			continue;
 		if (++n > 1)
@@ -135,7 +273,7 @@ clients_calculate_size(int type, int current, struct client *c,
     u_int *xpixel, u_int *ypixel)
 {
 	struct client	*loop;
-	u_int		 cx, cy, n = 0;
+	u_int		 cx, cy, i, n = 0;
 
 	/*
 	 * Start comparing with 0 for largest and UINT_MAX for smallest or
@@ -153,6 +291,7 @@ clients_calculate_size(int type, int current, struct client *c,
 		*sy = UINT_MAX;
 	}
 	*xpixel = *ypixel = 0;
+	clients_for_window(c, s, w);
 
 	/*
 	 * For latest, count the number of clients with this window. We only
@@ -166,7 +305,8 @@ clients_calculate_size(int type, int current, struct client *c,
 		goto skip;
 
 	/* Loop over the clients and work out the size. */
-	TAILQ_FOREACH(loop, &clients, entry) {
+	for (i = 0; i < resize_nclients; i++) {
+		loop = resize_clients[i];
 		if (loop != c && ignore_client_size(loop)) {
 			log_debug("%s: ignoring %s (1)", __func__, loop->name);
 			continue;
@@ -227,7 +367,8 @@ skip:
 	 * if one exists.
 	 */
 	if (w != NULL) {
-		TAILQ_FOREACH(loop, &clients, entry) {
+		for (i = 0; i < resize_nclients; i++) {
+			loop = resize_clients[i];
 			if (loop != c && ignore_client_size(loop))
 				continue;
 			if (loop != c && skip_client(loop, type, current, s, w))
@@ -355,8 +496,12 @@ recalculate_size_skip_client(struct client *loop, __unused int type,
 	return (session_has(loop->session, w) == 0);
 }
 
-void
-recalculate_size(struct window *w, int now)
+/*
+ * Work out the size of a window and resize it or schedule a resize. Returns 1
+ * if a resize was scheduled and the caller should decide when it happens.
+ */
+static int
+recalculate_window_size(struct window *w, int now)
 {
 	u_int	sx, sy, xpixel = 0, ypixel = 0;
 	int	type, current, changed;
@@ -366,7 +511,7 @@ recalculate_size(struct window *w, int now)
 	 * the way to destruction.
 	 */
 	if (w->active == NULL)
-		return;
+		return (0);
 	log_debug("%s: @%u is %ux%u", __func__, w->id, w->sx, w->sy);
 
 	/*
@@ -374,8 +519,8 @@ recalculate_size(struct window *w, int now)
 	 * aggressive-resize option (do not resize based on clients where the
 	 * window is not the current window).
 	 */
-	type = options_get_number(w->options, "window-size");
-	current = options_get_number(w->options, "aggressive-resize");
+	type = options_get_number_handle(w->options, &oh_window_size);
+	current = options_get_number_handle(w->options, &oh_aggressive_resize);
 
 	/* Look for a suitable client and get the new size. */
 	changed = clients_calculate_size(type, current, NULL, NULL, w,
@@ -400,7 +545,7 @@ recalculate_size(struct window *w, int now)
 	if (!changed) {
 		log_debug("%s: @%u no size change", __func__, w->id);
 		tty_update_window_offset(w);
-		return;
+		return (0);
 	}
 
 	/*
@@ -409,17 +554,32 @@ recalculate_size(struct window *w, int now)
 	 * later.
 	 */
 	log_debug("%s: @%u new size %ux%u", __func__, w->id, sx, sy);
-	if (now || type == WINDOW_SIZE_MANUAL)
+	if (now || type == WINDOW_SIZE_MANUAL) {
 		resize_window(w, sx, sy, xpixel, ypixel);
-	else {
-		w->new_sx = sx;
-		w->new_sy = sy;
-		w->new_xpixel = xpixel;
-		w->new_ypixel = ypixel;
-
-		w->flags |= WINDOW_RESIZE;
-		tty_update_window_offset(w);
+		return (0);
 	}
+
+	/*
+	 * If the window is already waiting to be resized, that resize will now
+	 * never happen.
+	 */
+	if (w->flags & WINDOW_RESIZE)
+		resize_avoided++;
+	w->new_sx = sx;
+	w->new_sy = sy;
+	w->new_xpixel = xpixel;
+	w->new_ypixel = ypixel;
+
+	w->flags |= WINDOW_RESIZE;
+	tty_update_window_offset(w);
+	return (1);
+}
+
+void
+recalculate_size(struct window *w, int now)
+{
+	if (recalculate_window_size(w, now))
+		resize_delay();
 }
 
 void
@@ -434,6 +594,10 @@ recalculate_sizes_now(int now)
 	struct session	*s;
 	struct client	*c;
 	struct window	*w;
+	struct timeval	 start, tv;
+	int		 scheduled = 0;
+
+	gettimeofday(&start, NULL);
 
 	/*
 	 * Clear attached count and update saved status line information for
@@ -460,7 +624,29 @@ recalculate_sizes_now(int now)
 			c->flags &= ~CLIENT_STATUSOFF;
 	}
 
-	/* Walk each window and adjust the size. */
-	RB_FOREACH(w, windows, &windows)
-		recalculate_size(w, now);
+	/*
+	 * Walk each window and adjust the size. Whether to delay is decided
+	 * once for all windows, so they are all resized together.
+	 */
+	RB_FOREACH(w, windows, &windows) {
+		if (recalculate_window_size(w, now))
+			scheduled = 1;
+	}
+	if (scheduled)
+		resize_delay();
+
+	gettimeofday(&tv, NULL);
+	timersub(&tv, &start, &tv);
+	resize_count++;
+	resize_time += tv.tv_sec * 1000000ULL + tv.tv_usec;
+	log_debug("%s: took %llu microseconds", __func__,
+	    (unsigned long long)(tv.tv_sec * 1000000ULL + tv.tv_usec));
+}
+
+/* Get size recalculation statistics. */
+void
+recalculate_sizes_stats(u_int *count, uint64_t *usec)
+{
+	*count = resize_count;
+	*usec = resize_time;
 }
@@ -24,6 +24,14 @@
 
 #include "tmux.h"
 
+/* Options read while redrawing. */
+static struct options_handle oh_border_indicators =
+    OPTIONS_HANDLE("pane-border-indicators");
+static struct options_handle oh_border_lines =
+    OPTIONS_HANDLE("pane-border-lines");
+static struct options_handle oh_status_position =
+    OPTIONS_HANDLE("status-position");
+
 /*
  * Draw the visible area of a window to a client.
  *
@@ -302,7 +310,8 @@ redraw_set_context(struct client *c, struct redraw_build_ctx *bctx)
 	bctx->w = w;
 	redraw_get_window_offset(c, &bctx->ox, &bctx->oy, &bctx->sx, &bctx->sy);
 
-	bctx->ind = options_get_number(w->options, "pane-border-indicators");
+	bctx->ind = options_get_number_handle(w->options,
+	    &oh_border_indicators);
 }
 
 /* Return a cell. */
@@ -1144,7 +1153,8 @@ redraw_get_default_border_style(struct redraw_draw_ctx *dctx,
 		memcpy(dgc, &grid_default_cell, sizeof *dgc);
 		style_add(dgc, oo, "pane-border-style", ft);
 		format_free(ft);
-		dctx->pane_lines = options_get_number(oo, "pane-border-lines");
+		dctx->pane_lines = options_get_number_handle(oo,
+		    &oh_border_lines);
 		dctx->flags |= REDRAW_DEFAULT_SET;
 	}
 	memcpy(gc, dgc, sizeof *gc);
@@ -1613,7 +1623,7 @@ redraw_set_draw_context(struct redraw_draw_ctx *dctx,
 	dctx->active = s->curw->window->active;
 
 	lines = status_line_size(c);
-	if (options_get_number(oo, "status-position") == 0)
+	if (options_get_number_handle(oo, &oh_status_position) == 0)
 		dctx->flags |= REDRAW_STATUS_TOP;
 	dctx->status_lines = lines;
 
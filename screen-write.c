@@ -23,6 +23,16 @@
 
 #include "tmux.h"
 
+/* Options read while writing. */
+static struct options_handle oh_alternate_screen =
+    OPTIONS_HANDLE("alternate-screen");
+static struct options_handle oh_extended_keys =
+    OPTIONS_HANDLE("extended-keys");
+static struct options_handle oh_scroll_on_clear =
+    OPTIONS_HANDLE("scroll-on-clear");
+static struct options_handle oh_vs_always_wide =
+    OPTIONS_HANDLE("variation-selector-always-wide");
+
 static struct screen_write_citem *screen_write_collect_trim(
 		    struct screen_write_ctx *, u_int, u_int, u_int, int *);
 static void	screen_write_collect_insert(struct screen_write_ctx *,
@@ -427,7 +437,7 @@ screen_write_reset(struct screen_write_ctx *ctx)
 
 	s->mode = MODE_CURSOR|MODE_WRAP;
 
-	if (options_get_number(global_options, "extended-keys") == 2)
+	if (options_get_number_handle(global_options, &oh_extended_keys) == 2)
 		s->mode = (s->mode & ~EXTENDED_KEY_MODES)|MODE_KEYS_EXTENDED;
 
 	screen_write_clearscreen(ctx, 8);
@@ -1936,7 +1946,7 @@ screen_write_clearendofscreen(struct screen_write_ctx *ctx, u_int bg)
 	    s->cy == 0 &&
 	    (gd->flags & GRID_HISTORY) &&
 	    ctx->wp != NULL &&
-	    options_get_number(ctx->wp->options, "scroll-on-clear"))
+	    options_get_number_handle(ctx->wp->options, &oh_scroll_on_clear))
 		grid_view_clear_history(gd, bg);
 	else {
 		if (s->cx <= sx - 1)
@@ -2088,7 +2098,7 @@ screen_write_clearscreen(struct screen_write_ctx *ctx, u_int bg)
 	/* Scroll into history if it is enabled. */
 	if ((s->grid->flags & GRID_HISTORY) &&
 	    ctx->wp != NULL &&
-	    options_get_number(ctx->wp->options, "scroll-on-clear"))
+	    options_get_number_handle(ctx->wp->options, &oh_scroll_on_clear))
 		grid_view_clear_history(s->grid, bg);
 	else
 		grid_view_clear(s->grid, 0, 0, sx, sy, bg);
@@ -2872,7 +2882,7 @@ screen_write_combine(struct screen_write_ctx *ctx, const struct grid_cell *gc)
 		zero_width = 1;
 	else if (utf8_is_vs(ud)) {
 		zero_width = 1;
-		if (options_get_number(oo, "variation-selector-always-wide"))
+		if (options_get_number_handle(oo, &oh_vs_always_wide))
 			force_wide = 1;
 	} else if (ud->width == 0)
 		zero_width = 1;
@@ -3144,7 +3154,8 @@ screen_write_alternateon(struct screen_write_ctx *ctx, struct grid_cell *gc,
 	struct tty_ctx			 ttyctx;
 	struct window_pane		*wp = ctx->wp;
 
-	if (wp != NULL && !options_get_number(wp->options, "alternate-screen"))
+	if (wp != NULL &&
+	    !options_get_number_handle(wp->options, &oh_alternate_screen))
 		return;
 
 	screen_write_collect_flush(ctx, 0, __func__);
@@ -3176,7 +3187,8 @@ screen_write_alternateoff(struct screen_write_ctx *ctx, struct grid_cell *gc,
 	struct tty_ctx		 ttyctx;
 	struct window_pane	*wp = ctx->wp;
 
-	if (wp != NULL && !options_get_number(wp->options, "alternate-screen"))
+	if (wp != NULL &&
+	    !options_get_number_handle(wp->options, &oh_alternate_screen))
 		return;
 
 	screen_write_collect_flush(ctx, 0, __func__);
@@ -416,6 +416,16 @@ screen_resize_y(struct screen *s, u_int sy, int eat_empty, u_int *cy)
 		fatalx("zero size");
 	oldy = screen_size_y(s);
 
+	/*
+	 * If lines may be pulled from history that has not been reflowed yet,
+	 * reflow it now.
+	 */
+	if (sy > oldy && gd->hsize < gd->reflow_lines + (sy - oldy)) {
+		i = gd->hsize;
+		grid_reflow_history(gd, 0);
+		*cy = (*cy - i) + gd->hsize;
+	}
+
 	/*
 	 * When resizing:
 	 *
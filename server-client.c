@@ -446,6 +446,20 @@ server_client_fire_resized(struct client *c, u_int old_sx, u_int old_sy)
 	events_fire("client-resized", ep);
 }
 
+/*
+ * Change client session without any other side effects, keeping the list of
+ * clients for each session up to date. Dead clients are not in any list.
+ */
+void
+server_client_link_session(struct client *c, struct session *s)
+{
+	if (c->session != NULL && (~c->flags & CLIENT_DEAD))
+		TAILQ_REMOVE(&c->session->clients, c, sentry);
+	c->session = s;
+	if (s != NULL && (~c->flags & CLIENT_DEAD))
+		TAILQ_INSERT_TAIL(&s->clients, c, sentry);
+}
+
 /* Set client session. */
 void
 server_client_set_session(struct client *c, struct session *s)
@@ -456,7 +470,7 @@ server_client_set_session(struct client *c, struct session *s)
 		c->last_session = c->session;
 	else if (s == NULL)
 		c->last_session = NULL;
-	c->session = s;
+	server_client_link_session(c, s);
 	c->flags |= CLIENT_FOCUSED;
 
 	if (old != NULL && old->curw != NULL)
@@ -488,6 +502,8 @@ server_client_lost(struct client *c)
 
 	if (cfg_client == c)
 		cfg_client = NULL;
+	if (c->session != NULL)
+		TAILQ_REMOVE(&c->session->clients, c, sentry);
 	c->flags |= CLIENT_DEAD;
 
 	server_client_clear_overlay(c);
@@ -1403,6 +1419,63 @@ server_client_handle_dead_key(struct window_pane *wp, key_code key)
 	return (1);
 }
 
+/*
+ * Can input from the client be passed to the active pane as one block rather
+ * than key by key? Only if no key would be handled before it reaches the
+ * queue. Outside a bracketed paste, the keys must also go straight to the
+ * pane, so the client must be in the root table with nothing waiting in the
+ * queue which could change that.
+ */
+int
+server_client_can_paste_block(struct client *c, int bracket)
+{
+	struct session		*s = c->session;
+	struct window		*w;
+	struct window_pane	*wp, *loop;
+
+	if (s == NULL || (c->flags & (CLIENT_UNATTACHEDFLAGS|CLIENT_READONLY)))
+		return (0);
+	if (c->message_string != NULL ||
+	    c->overlay_key != NULL ||
+	    c->prompt != NULL)
+		return (0);
+	w = s->curw->window;
+	if (w->menu != NULL)
+		return (0);
+	wp = w->active;
+	if (wp == NULL || (wp->flags & PANE_CAPTUREALLKEYS))
+		return (0);
+	TAILQ_FOREACH(loop, &w->panes, entry) {
+		if (window_pane_has_prompt(loop))
+			return (0);
+	}
+	if (bracket)
+		return (1);
+
+	if (!cmdq_empty(c))
+		return (0);
+	if ((c->flags & CLIENT_REPEAT) ||
+	    !server_client_is_default_key_table(c, c->keytable))
+		return (0);
+	if (!TAILQ_EMPTY(&wp->modes) || window_pane_exited(wp))
+		return (0);
+	if (key_bindings_get(c->keytable, KEYC_ANY) != NULL)
+		return (0);
+	return (1);
+}
+
+/* Is this key the prefix or bound in the client key table? */
+int
+server_client_key_is_bound(struct client *c, key_code key)
+{
+	struct session	*s = c->session;
+
+	if (key == (key_code)options_get_number(s->options, "prefix") ||
+	    key == (key_code)options_get_number(s->options, "prefix2"))
+		return (1);
+	return (key_bindings_get(c->keytable, key) != NULL);
+}
+
 /*
  * Handle data key input from client. This owns and can modify the key event it
  * is given and is responsible for freeing it.
@@ -1472,6 +1545,10 @@ server_client_key_callback(struct cmdq_item *item, void *data)
 		cmd_find_from_client(&fs, c, 0);
 	wp = fs.wp;
 
+	/* Blocks of pasted text go straight to the pane. */
+	if (key == KEYC_NONE)
+		goto paste_key;
+
 	/* Forward mouse keys if disabled. */
 	if (KEYC_IS_MOUSE(key) && !options_get_number(s->options, "mouse"))
 		goto forward_key;
@@ -1922,6 +1999,8 @@ server_client_check_window_resize(struct window *w)
 
 	if (~w->flags & WINDOW_RESIZE)
 		return;
+	if (resize_is_delayed())
+		return;
 
 	TAILQ_FOREACH(wl, &w->winlinks, wentry) {
 		if (wl->session->attached != 0 && wl->session->curw == wl)
@@ -3067,6 +3146,8 @@ server_client_control_flags(struct client *c, const char *next)
 		return (CLIENT_CONTROL_NOOUTPUT);
 	if (strcmp(next, "wait-exit") == 0)
 		return (CLIENT_CONTROL_WAITEXIT);
+	if (strcmp(next, "request-ids") == 0)
+		return (CLIENT_CONTROL_REQUESTS);
 	return (0);
 }
 
@@ -3133,6 +3214,8 @@ server_client_get_flags(struct client *c)
 		strlcat(s, "no-output,", sizeof s);
 	if (c->flags & CLIENT_CONTROL_WAITEXIT)
 		strlcat(s, "wait-exit,", sizeof s);
+	if (c->flags & CLIENT_CONTROL_REQUESTS)
+		strlcat(s, "request-ids,", sizeof s);
 	if (c->flags & CLIENT_CONTROL_PAUSEAFTER) {
 		xsnprintf(tmp, sizeof tmp, "pause-after=%u,",
 		    c->pause_age / 1000);
@@ -362,6 +362,7 @@ server_destroy_pane(struct window_pane *wp, int notify)
 	u_int			 sx = screen_size_x(&wp->base);
 	u_int			 sy = screen_size_y(&wp->base);
 
+	paste_cancel(wp);
 	if (wp->fd != -1) {
 #ifdef HAVE_UTEMPTER
 		utempter_remove_record(wp->fd);
@@ -516,7 +517,7 @@ server_destroy_session(struct session *s)
 		if (use_s == NULL && (c->flags & CLIENT_NO_DETACH_ON_DESTROY))
 			use_s = cs_new;
 
-		c->session = NULL;
+		server_client_link_session(c, NULL);
 		c->last_session = NULL;
 		server_client_set_session(c, use_s);
 		if (use_s == NULL)
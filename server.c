@@ -278,9 +278,11 @@ server_loop(void)
 			if (c->flags & CLIENT_IDENTIFIED)
 				items += cmdq_next(c);
 		}
+		items += events_flush();
 	} while (items != 0);
 
 	server_client_loop();
+	events_flush();
 
 	if (!options_get_number(global_options, "exit-empty") && !server_exit)
 		return (0);
@@ -325,7 +327,7 @@ server_send_exit(void)
 			c->flags |= CLIENT_EXIT;
 			c->exit_type = CLIENT_EXIT_SHUTDOWN;
 		}
-		c->session = NULL;
+		server_client_link_session(c, NULL);
 	}
 
 	RB_FOREACH_SAFE(s, sessions, &sessions, s1)
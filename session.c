@@ -120,6 +120,7 @@ session_create(const char *prefix, const char *name, const char *cwd,
 
 	TAILQ_INIT(&s->lastw);
 	RB_INIT(&s->windows);
+	TAILQ_INIT(&s->clients);
 
 	s->environ = env;
 	s->options = oo;
@@ -671,16 +672,17 @@ session_group_synchronize_from(struct session *target)
 }
 
 /*
- * Synchronize a session with a target session. This means destroying all
- * winlinks then recreating them, then updating the current window, last window
- * stack and alerts.
+ * Synchronize a session with a target session. Winlinks with the same index
+ * and window in both are kept; others are removed and any missing are added.
+ * Then the current window, last window stack and alerts are updated.
  */
 static void
 session_group_synchronize1(struct session *target, struct session *s)
 {
 	struct winlinks		 old_windows, *ww;
 	struct winlink_stack	 old_lastw;
-	struct winlink		*wl, *wl2;
+	struct winlink		*wl, *wl1, *wl2;
+	int			 changed = 0, curidx;
 
 	/* Don't do anything if the session is empty (it'll be destroyed). */
 	ww = &target->windows;
@@ -692,40 +694,67 @@ session_group_synchronize1(struct session *target, struct session *s)
 	    winlink_find_by_index(ww, s->curw->idx) == NULL &&
 	    session_last(s) != 0 && session_previous(s, 0) != 0)
 		session_next(s, 0);
+	if (s->curw != NULL)
+		curidx = s->curw->idx;
+	else
+		curidx = -1;
+
+	/*
+	 * Move winlinks which are not in the target (or have a different
+	 * window) out of the way. They are freed at the end.
+	 */
+	RB_INIT(&old_windows);
+	RB_FOREACH_SAFE(wl, winlinks, &s->windows, wl1) {
+		wl2 = winlink_find_by_index(ww, wl->idx);
+		if (wl2 == NULL || wl2->window != wl->window) {
+			RB_REMOVE(winlinks, &s->windows, wl);
+			RB_INSERT(winlinks, &old_windows, wl);
+			changed = 1;
+		}
+	}
 
-	/* Save the old pointer and reset it. */
-	memcpy(&old_windows, &s->windows, sizeof old_windows);
-	RB_INIT(&s->windows);
-
-	/* Link all the windows from the target. */
+	/* Link any missing windows from the target and copy alerts. */
 	RB_FOREACH(wl, winlinks, ww) {
-		wl2 = winlink_add(&s->windows, wl->idx);
-		wl2->session = s;
-		winlink_set_window(wl2, wl->window);
-		events_fire_winlink("window-linked", wl2);
+		wl2 = winlink_find_by_index(&s->windows, wl->idx);
+		if (wl2 == NULL) {
+			wl2 = winlink_add(&s->windows, wl->idx);
+			wl2->session = s;
+			winlink_set_window(wl2, wl->window);
+			events_fire_winlink("window-linked", wl2);
+			changed = 1;
+		}
+		wl2->flags &= ~WINLINK_ALERTFLAGS;
 		wl2->flags |= wl->flags & WINLINK_ALERTFLAGS;
 	}
+	if (!changed && s->curw != NULL)
+		return;
 
 	/* Fix up the current window. */
-	if (s->curw != NULL)
-		s->curw = winlink_find_by_index(&s->windows, s->curw->idx);
+	if (curidx != -1)
+		s->curw = winlink_find_by_index(&s->windows, curidx);
 	else if (target->curw != NULL)
 		s->curw = winlink_find_by_index(&s->windows, target->curw->idx);
 	if (s->curw == NULL)
 		s->curw = RB_MIN(winlinks, &s->windows);
 
-	/* Fix up the last window stack. */
+	/*
+	 * Fix up the last window stack, replacing removed winlinks with the
+	 * new winlink at the same index if there is one.
+	 */
 	memcpy(&old_lastw, &s->lastw, sizeof old_lastw);
 	TAILQ_INIT(&s->lastw);
-	TAILQ_FOREACH(wl, &old_lastw, sentry) {
-		wl2 = winlink_find_by_index(&s->windows, wl->idx);
+	TAILQ_FOREACH_SAFE(wl, &old_lastw, sentry, wl1) {
+		if (RB_FIND(winlinks, &old_windows, wl) == wl)
+			wl2 = winlink_find_by_index(&s->windows, wl->idx);
+		else
+			wl2 = wl;
 		if (wl2 != NULL) {
 			TAILQ_INSERT_TAIL(&s->lastw, wl2, sentry);
 			wl2->flags |= WINLINK_VISITED;
 		}
 	}
 
-	/* Then free the old winlinks list. */
+	/* Then free the removed winlinks. */
 	while (!RB_EMPTY(&old_windows)) {
 		wl = RB_ROOT(&old_windows);
 		wl2 = winlink_find_by_window_id(&s->windows, wl->window->id);
@@ -790,6 +819,8 @@ session_renumber_windows(struct session *s)
 	/* Free the old winlinks (reducing window references too). */
 	RB_FOREACH_SAFE(wl, winlinks, &old_wins, wl1)
 		winlink_remove(&old_wins, wl);
+
+	events_fire_session("session-windows-changed", s);
 }
 
 /* Set the PANE_THEMECHANGED flag for every pane in this session. */
@@ -317,6 +317,7 @@ spawn_pane(struct spawn_context *sc, char **cause)
 			free(cwd);
 			return (NULL);
 		}
+		paste_cancel(sc->wp0);
 		if (sc->wp0->event != NULL) {
 			bufferevent_free(sc->wp0->event);
 			sc->wp0->event = NULL;
@@ -29,6 +29,14 @@
 
 #include "tmux.h"
 
+/* Options read while redrawing. */
+static struct options_handle oh_status =
+    OPTIONS_HANDLE("status");
+static struct options_handle oh_status_position =
+    OPTIONS_HANDLE("status-position");
+static struct options_handle oh_status_interval =
+    OPTIONS_HANDLE("status-interval");
+
 static void	 status_message_area(struct client *, u_int *, u_int *);
 static void	 status_message_callback(int, short, void *);
 static void	 status_timer_callback(int, short, void *);
@@ -50,7 +58,7 @@ status_timer_callback(__unused int fd, __unused short events, void *arg)
 		c->flags |= CLIENT_REDRAWSTATUS;
 
 	timerclear(&tv);
-	tv.tv_sec = options_get_number(s->options, "status-interval");
+	tv.tv_sec = options_get_number_handle(s->options, &oh_status_interval);
 
 	if (tv.tv_sec != 0)
 		evtimer_add(&c->status.timer, &tv);
@@ -68,7 +76,7 @@ status_timer_start(struct client *c)
 	else
 		evtimer_set(&c->status.timer, status_timer_callback, c);
 
-	if (s != NULL && options_get_number(s->options, "status"))
+	if (s != NULL && options_get_number_handle(s->options, &oh_status))
 		status_timer_callback(-1, 0, c);
 }
 
@@ -86,10 +94,11 @@ status_timer_start_all(void)
 void
 status_update_cache(struct session *s)
 {
-	s->statuslines = options_get_number(s->options, "status");
+	s->statuslines = options_get_number_handle(s->options, &oh_status);
 	if (s->statuslines == 0)
 		s->statusat = -1;
-	else if (options_get_number(s->options, "status-position") == 0)
+	else if (options_get_number_handle(s->options,
+	    &oh_status_position) == 0)
 		s->statusat = 0;
 	else
 		s->statusat = 1;
@@ -117,7 +126,8 @@ status_line_size(struct client *c)
 	if (c->flags & (CLIENT_STATUSOFF|CLIENT_CONTROL))
 		return (0);
 	if (s == NULL)
-		return (options_get_number(global_s_options, "status"));
+		return (options_get_number_handle(global_s_options,
+		    &oh_status));
 	return (s->statuslines);
 }
 
@@ -644,7 +654,8 @@ status_prompt_screen_line(struct client *c)
 	struct tty	*tty = &c->tty;
 	u_int		 n;
 
-	if (options_get_number(c->session->options, "status-position") == 0)
+	if (options_get_number_handle(c->session->options,
+	    &oh_status_position) == 0)
 		return (status_prompt_line_at(c));
 	n = status_line_size(c) - status_prompt_line_at(c);
 	if (n <= tty->sy)
@@ -54,6 +54,8 @@ struct event_payload_item;
 struct events_sink;
 struct format_job_tree;
 struct format_tree;
+struct fuzzy_pattern;
+struct fuzzy_text;
 struct hyperlinks_uri;
 struct hyperlinks;
 struct input_ctx;
@@ -66,6 +68,7 @@ struct mouse_event;
 struct options;
 struct options_array_item;
 struct options_entry;
+struct paste_data;
 struct prompt;
 struct window_pane_prompt;
 struct redraw_scene;
@@ -81,7 +84,7 @@ struct sixel_image;
 
 struct tty_ctx;
 struct tty_code;
-struct tty_key;
+struct tty_key_tree;
 struct tmuxpeer;
 struct tmuxproc;
 struct winlink;
@@ -929,6 +932,8 @@ struct grid {
 	u_int			 scroll_collected;
 	u_int			 scroll_generation;
 
+	u_int			 reflow_lines;
+
 	struct grid_line	*linedata;
 };
 
@@ -1022,12 +1027,34 @@ struct style {
 };
 
 #ifdef ENABLE_SIXEL
+/* Image encoded for a particular cell size and visible area. */
+struct image_encoded {
+	struct image			*im;
+
+	u_int				 xpixel;
+	u_int				 ypixel;
+	u_int				 ox;
+	u_int				 oy;
+	u_int				 sx;
+	u_int				 sy;
+
+	char				*data;
+	size_t				 size;
+
+	TAILQ_ENTRY (image_encoded)	 entry;
+	TAILQ_ENTRY (image_encoded)	 all_entry;
+};
+TAILQ_HEAD(image_encoded_list, image_encoded);
+
 /* Image. */
 struct image {
 	struct screen		*s;
 	struct sixel_image	*data;
 	char			*fallback;
 
+	struct image_encoded_list encoded;
+	size_t			 size;
+
 	u_int			 px;
 	u_int			 py;
 	u_int			 sx;
@@ -1273,6 +1300,22 @@ struct window_pane_resize {
 };
 TAILQ_HEAD(window_pane_resizes, window_pane_resize);
 
+/* Paste being written into a pane. */
+struct window_pane_paste {
+	struct paste_data		*pd;
+	size_t				 offset;
+	size_t				 size;
+
+	char				*separator;
+	int				 flags;
+#define PASTE_RAW 0x1
+#define PASTE_BRACKET 0x2
+#define PASTE_BRACKETED 0x4
+
+	TAILQ_ENTRY(window_pane_paste)	 entry;
+};
+TAILQ_HEAD(window_pane_pastes, window_pane_paste);
+
 /*
  * Client theme, this is worked out from the background colour if not reported
  * by terminal.
@@ -1296,6 +1339,20 @@ struct visible_ranges {
 	u_int			 size;    /* allocated capacity of ranges */
 };
 
+/* Cached foreground process information for a pane. */
+struct window_pane_proc {
+	pid_t		 pgrp;
+	time_t		 time;
+
+	int		 flags;
+#define PANE_PROC_NAME 0x1
+#define PANE_PROC_CWD 0x2
+#define PANE_PROC_STALE 0x4
+
+	char		*name;
+	char		*cwd;
+};
+
 /* Child window structure. */
 struct window_pane {
 	u_int		 id;
@@ -1337,6 +1394,7 @@ struct window_pane {
 #define PANE_CLOSEONCLICK 0x80000
 #define PANE_CAPTUREALLKEYS 0x100000
 #define PANE_FLOATOVERZOOM 0x200000
+#define PANE_REFLOWQUEUED 0x400000
 
 	bitstr_t	*sync_dirty;
 	u_int		 sync_dirty_size;
@@ -1355,6 +1413,9 @@ struct window_pane {
 	pid_t		 pid;
 	char		 tty[TTY_NAME_MAX];
 	int		 status;
+
+	struct window_pane_proc proc;
+
 	struct timeval	 dead_time;
 	struct cmdq_item *wait_item;	/* new-pane -W: waiting for pane exit */
 	struct spawn_editor_state *editor;
@@ -1375,6 +1436,9 @@ struct window_pane {
 	struct event	 resize_timer;
 	struct event	 sync_timer;
 
+	struct window_pane_pastes pastes;
+	struct event	 paste_timer;
+
 	struct input_ctx *ictx;
 
 	struct grid_cell cached_gc;
@@ -1418,6 +1482,7 @@ struct window_pane {
 
 	TAILQ_ENTRY(window_pane) entry;  /* link in list of all panes */
 	TAILQ_ENTRY(window_pane) sentry; /* link in list of last visited */
+	TAILQ_ENTRY(window_pane) rentry; /* link in list waiting to reflow */
         TAILQ_ENTRY(window_pane) zentry; /* z-index link in list of all panes */
 	RB_ENTRY(window_pane) tree_entry;
 };
@@ -1633,6 +1698,7 @@ struct session {
 	int		 flags;
 
 	u_int		 attached;
+	TAILQ_HEAD(, client) clients;
 
 	struct termios	*tio;
 
@@ -1835,7 +1901,7 @@ struct tty {
 			    struct mouse_event *);
 
 	struct event	 key_timer;
-	struct tty_key	*key_tree;
+	struct tty_key_tree *key_tree;
 };
 
 /* Terminal command context. */
@@ -2058,6 +2124,7 @@ struct cmd_entry {
 #define CMD_CLIENT_CFLAG 0x8
 #define CMD_CLIENT_TFLAG 0x10
 #define CMD_CLIENT_CANFAIL 0x20
+#define CMD_QUERY 0x40
 	int		 flags;
 
 	enum cmd_retval	 (*exec)(struct cmd *, struct cmdq_item *);
@@ -2294,7 +2361,7 @@ struct client {
 #define CLIENT_CONTROL_PAUSEAFTER 0x100000000ULL
 #define CLIENT_CONTROL_WAITEXIT 0x200000000ULL
 #define CLIENT_WINDOWSIZECHANGED 0x400000000ULL
-/* 0x800000000ULL unused */
+#define CLIENT_CONTROL_REQUESTS 0x800000000ULL
 #define CLIENT_BRACKETPASTING 0x1000000000ULL
 #define CLIENT_ASSUMEPASTING 0x2000000000ULL
 #define CLIENT_WRITE_ACK 0x4000000000ULL
@@ -2366,6 +2433,7 @@ struct client {
 	u_int			 clipboard_npanes;
 
 	TAILQ_ENTRY(client)	 entry;
+	TAILQ_ENTRY(client)	 sentry;
 };
 TAILQ_HEAD(clients, client);
 
@@ -2407,6 +2475,7 @@ enum event_payload_type {
 /* Event payload callbacks. */
 typedef void (*event_payload_free_cb)(void *);
 typedef void (*event_payload_print_cb)(void *, struct evbuffer *);
+typedef void (*event_payload_fill_cb)(struct event_payload *, void *);
 
 /* Key binding and key table. */
 struct key_binding {
@@ -2493,6 +2562,16 @@ struct options_name_map {
 	const char		*to;
 };
 
+/*
+ * Option found by its ID in the options table instead of by name, for options
+ * read often. The ID is looked up from the name on first use.
+ */
+struct options_handle {
+	const char		*name;
+	int			 id;
+};
+#define OPTIONS_HANDLE(name) { name, -1 }
+
 /* Common command usages. */
 #define CMD_TARGET_PANE_USAGE "[-t target-pane]"
 #define CMD_TARGET_WINDOW_USAGE "[-t target-window]"
@@ -2541,7 +2620,7 @@ struct spawn_context {
 
 /* Paste buffer. */
 struct paste_buffer {
-	char		*data;
+	struct paste_data *pd;
 	size_t		 size;
 
 	char		*name;
@@ -2643,6 +2722,14 @@ int		 paste_rename(const char *, const char *, char **);
 int		 paste_set(char *, size_t, const char *, char **);
 void		 paste_replace(struct paste_buffer *, char *, size_t);
 char		*paste_make_sample(struct paste_buffer *);
+void		 paste_stats(size_t *, size_t *);
+#define PASTE_CHUNK_SIZE 16384
+void		 paste_send(struct window_pane *, struct paste_buffer *,
+		     const char *, int);
+void		 paste_send_next(struct window_pane *);
+void		 paste_flush(struct window_pane *);
+void		 paste_cancel(struct window_pane *);
+void		 paste_progress(struct window_pane *, size_t *, size_t *);
 
 /* sort.c */
 void			  sort_next_order(struct sort_criteria *);
@@ -2679,6 +2766,7 @@ struct format_tree;
 struct format_modifier;
 typedef void *(*format_cb)(struct format_tree *);
 void		 format_tidy_jobs(void);
+int		 format_print_jobs(struct cmdq_item *, int);
 const char	*format_skip(const char *, const char *);
 int		 format_true(const char *);
 struct format_tree *format_create(struct client *, struct cmdq_item *, int,
@@ -2724,11 +2812,18 @@ char		*format_grid_line(struct grid *, u_int);
 /* events-payload.c */
 struct event_payload *event_payload_create(void);
 void	 event_payload_free(struct event_payload *);
+void	 event_payload_set_fill(struct event_payload *,
+	     event_payload_fill_cb, void *);
+int	 event_payload_can_keep(struct event_payload *);
 void printflike(2, 3) event_payload_log(struct event_payload *, const char *,
 	     ...);
 char	*event_payload_item_print(struct event_payload_item *);
 void	 event_payload_set_target(struct event_payload *,
 	     struct cmd_find_state *);
+int	 event_payload_cmp_target(struct event_payload *,
+	     struct event_payload *);
+void	 event_payload_move_old(struct event_payload *,
+	     struct event_payload *);
 int	 event_payload_get_target(struct event_payload *,
 	     struct cmd_find_state *);
 void printflike(3, 4) event_payload_set_string(struct event_payload *,
@@ -2768,7 +2863,12 @@ void	*event_payload_get_pointer(struct event_payload *, const char *);
 typedef void (*events_cb)(const char *, struct event_payload *, void *);
 struct events_sink *events_add_sink(const char *, events_cb, void *);
 void	 events_remove_sink(struct events_sink *);
+void	 events_set_sink_active(struct events_sink *, int);
+int	 events_has_sinks(const char *);
 void	 events_fire(const char *, struct event_payload *);
+void	 events_update_coalesce(void);
+u_int	 events_coalesced_count(void);
+u_int	 events_flush(void);
 void	 events_fire_client(const char *, struct client *);
 void	 events_fire_session(const char *, struct session *);
 void	 events_fire_window(const char *, struct window *);
@@ -2785,6 +2885,7 @@ char	*format_trim_right(const char *, u_int);
 /* hooks.c */
 void	 hooks_add_event(const char *);
 int	 hooks_is_event(const char *);
+void	 hooks_count_command(const char *, int);
 int	 hooks_valid_event_name(const char *);
 void	 hooks_build_events(void);
 void	 hooks_run(struct cmdq_item *, const char *);
@@ -2821,6 +2922,8 @@ time_t		 options_get_fire_time(struct options_entry *);
 const struct options_table_entry *options_table_entry(struct options_entry *);
 struct options_entry *options_get_only(struct options *, const char *);
 struct options_entry *options_get(struct options *, const char *);
+struct options_entry *options_get_handle(struct options *,
+		     struct options_handle *);
 void		 options_array_clear(struct options_entry *);
 union options_value *options_array_get(struct options_entry *, const char *);
 union options_value * printflike(2, 3) options_array_getv(
@@ -2845,6 +2948,10 @@ struct options_entry *options_match_get(struct options *, const char *,
 		     char **, int, int *);
 const char	*options_get_string(struct options *, const char *);
 long long	 options_get_number(struct options *, const char *);
+const char	*options_get_string_handle(struct options *,
+		     struct options_handle *);
+long long	 options_get_number_handle(struct options *,
+		     struct options_handle *);
 struct cmd_list *options_get_command(struct options *, const char *);
 struct options_entry * printflike(4, 5) options_set_string(struct options *,
 		     const char *, int, const char *, ...);
@@ -2881,6 +2988,7 @@ typedef void (*job_free_cb) (void *);
 #define JOB_PTY 0x4
 #define JOB_DEFAULTSHELL 0x8
 #define JOB_SHOWSTDERR 0x10
+#define JOB_POOL 0x20
 struct job	*job_run(const char *, int, char **, struct environ *,
 		     struct session *, const char *, job_update_cb,
 		     job_complete_cb, job_free_cb, void *, int, int, int);
@@ -2893,7 +3001,10 @@ void		*job_get_data(struct job *);
 struct bufferevent *job_get_event(struct job *);
 void		 job_kill_all(void);
 int		 job_still_running(void);
-void		 job_print_summary(struct cmdq_item *, int);
+int		 job_print_summary(struct cmdq_item *, int);
+void		 job_pool_dispatch(void);
+void		 job_pool_stats(u_int *, u_int *, u_int *, u_int *, u_int *,
+		     u_int *);
 
 /* environ.c */
 struct environ *environ_create(void);
@@ -3045,6 +3156,7 @@ const struct utf8_data *tty_acs_rounded_borders(int);
 /* tty-keys.c */
 void		tty_keys_build(struct tty *);
 void		tty_keys_free(struct tty *);
+u_int		tty_keys_trees_built(void);
 int		tty_keys_next(struct tty *);
 int		tty_keys_colours(struct tty *, const char *, size_t, size_t *,
 		     int *, int *);
@@ -3210,12 +3322,14 @@ struct cmdq_item *cmdq_get_command(struct cmd_list *, struct cmdq_state *);
 struct cmdq_item *cmdq_get_callback1(const char *, cmdq_cb, void *);
 struct cmdq_item *cmdq_get_error(const char *);
 struct cmdq_item *cmdq_insert_after(struct cmdq_item *, struct cmdq_item *);
+void		 cmdq_set_request(struct cmdq_item *, const char *);
 struct cmdq_item *cmdq_append(struct client *, struct cmdq_item *);
 void printflike(4, 5) cmdq_insert_hook(struct session *, struct cmdq_item *,
 		     struct cmd_find_state *, const char *, ...);
 void		 cmdq_continue(struct cmdq_item *);
 u_int		 cmdq_next(struct client *);
 struct cmdq_item *cmdq_running(struct client *);
+int		 cmdq_empty(struct client *);
 void		 cmdq_guard(struct cmdq_item *, const char *, int);
 void printflike(2, 3) cmdq_print(struct cmdq_item *, const char *, ...);
 void 		 cmdq_print_data(struct cmdq_item *, struct evbuffer *);
@@ -3324,12 +3438,15 @@ void	 server_client_set_key_table(struct client *, const char *);
 const char *server_client_get_key_table(struct client *);
 int	 server_client_check_nested(struct client *);
 int	 server_client_handle_key(struct client *, struct key_event *);
+int	 server_client_can_paste_block(struct client *, int);
+int	 server_client_key_is_bound(struct client *, key_code);
 int	 server_client_handle_key_after(struct client *, struct key_event *,
 	     struct cmdq_item *, struct cmdq_item **);
 struct client *server_client_create(int);
 int	 server_client_open(struct client *, char **);
 void	 server_client_unref(struct client *);
 void	 server_client_set_session(struct client *, struct session *);
+void	 server_client_link_session(struct client *, struct session *);
 void	 server_client_lost(struct client *);
 void	 server_client_suspend(struct client *);
 void	 server_client_detach(struct client *, enum msgtype);
@@ -3419,11 +3536,14 @@ void	 prompt_save_history(void);
 
 /* resize.c */
 void	 resize_window(struct window *, u_int, u_int, int, int);
+int	 resize_is_delayed(void);
+u_int	 resize_avoided_count(void);
 void	 default_window_size(struct client *, struct session *, struct window *,
 	     u_int *, u_int *, u_int *, u_int *, int);
 void	 recalculate_size(struct window *, int);
 void	 recalculate_sizes(void);
 void	 recalculate_sizes_now(int);
+void	 recalculate_sizes_stats(u_int *, uint64_t *);
 
 /* input.c */
 #define INPUT_BUF_DEFAULT_SIZE 1048576
@@ -3477,6 +3597,13 @@ const char *attributes_tostring(int);
 int	 attributes_fromstring(const char *);
 
 /* fuzzy.c */
+struct fuzzy_pattern *fuzzy_pattern_create(const char *);
+void	 fuzzy_pattern_free(struct fuzzy_pattern *);
+int	 fuzzy_pattern_narrows(const char *, const char *);
+struct fuzzy_text *fuzzy_text_create(const char *);
+void	 fuzzy_text_free(struct fuzzy_text *);
+bitstr_t	*fuzzy_match_text(const struct fuzzy_pattern *,
+	     const struct fuzzy_text *, u_int, u_int *);
 bitstr_t	*fuzzy_match(const char *, const char *, u_int, u_int *);
 
 /* grid.c */
@@ -3517,6 +3644,7 @@ char	*grid_string_cells(struct grid *, u_int, u_int, u_int,
 void	 grid_duplicate_lines(struct grid *, u_int, struct grid *, u_int,
 	     u_int);
 void	 grid_reflow(struct grid *, u_int);
+u_int	 grid_reflow_history(struct grid *, u_int);
 void	 grid_wrap_position(struct grid *, u_int, u_int, u_int *, u_int *);
 void	 grid_unwrap_position(struct grid *, u_int *, u_int *, u_int, u_int);
 u_int	 grid_line_length(struct grid *, u_int);
@@ -3775,6 +3903,8 @@ void		 window_pane_update_prompt(struct window_pane *, const char *,
 		     const char *);
 enum prompt_key_result window_pane_prompt_key(struct window_pane *,
 		     struct client *, key_code, struct mouse_event *);
+void		 window_pane_reflow_queue(struct window_pane *);
+u_int		 window_pane_reflow_pending(void);
 int		 window_pane_is_visible(struct window_pane *);
 int		 window_pane_exited(struct window_pane *);
 u_int		 window_pane_search(struct window_pane *, const char *, int,
@@ -3932,6 +4062,7 @@ typedef int (*mode_tree_swap_cb)(void *, void *, struct sort_criteria *);
 typedef void (*mode_tree_sort_cb)(struct sort_criteria *);
 typedef void (*mode_tree_each_cb)(void *, void *, struct client *, key_code);
 typedef const char** (*mode_tree_help_cb)(u_int *, const char**);
+typedef char *(*mode_tree_text_cb)(void *, void *);
 u_int	 mode_tree_count_tagged(struct mode_tree_data *);
 void	*mode_tree_get_current(struct mode_tree_data *);
 const char *mode_tree_get_current_name(struct mode_tree_data *);
@@ -3951,6 +4082,8 @@ struct mode_tree_data *mode_tree_start(struct window_pane *, struct args *,
 	     const struct menu_item *, struct screen **);
 void	 mode_tree_zoom(struct mode_tree_data *, struct args *);
 void	 mode_tree_build(struct mode_tree_data *);
+void	 mode_tree_watch(struct mode_tree_data *, const char **);
+void	 mode_tree_update(struct mode_tree_data *, mode_tree_text_cb);
 void	 mode_tree_free(struct mode_tree_data *);
 void	 mode_tree_resize(struct mode_tree_data *, u_int, u_int);
 struct mode_tree_item *mode_tree_add(struct mode_tree_data *,
@@ -4016,6 +4149,9 @@ extern const struct window_mode window_customize_mode;
 void	 check_window_name(struct window *);
 char	*default_window_name(struct window *);
 char	*parse_window_name(const char *);
+const char *get_pane_command(struct window_pane *);
+const char *get_pane_cwd(struct window_pane *, int);
+void	 name_lookup_stats(u_int *, u_int *);
 
 /* monitor.c */
 struct monitor_set *monitor_create_client(struct client *, monitor_cb, void *);
@@ -4049,12 +4185,15 @@ struct window_pane_offset *control_pane_offset(struct client *,
 void	control_reset_offsets(struct client *);
 void printflike(2, 3) control_write(struct client *, const char *, ...);
 void printflike(2, 3) control_notify_write(struct client *, const char *, ...);
-void	control_write_guard(struct client *, const char *, long, u_int, int);
+void	control_write_guard(struct client *, const char *, long, u_int, int,
+	    const char *);
 void	control_write_output(struct client *, struct window_pane *);
 int	control_all_done(struct client *);
 void	control_add_sub(struct client *, const char *, enum monitor_type, int,
 	    const char *);
 void	control_remove_sub(struct client *, const char *);
+void	control_flush_parse_cache(void);
+void	control_parse_stats(u_int *, u_int *);
 
 /* control-notify.c */
 void	control_build_events(void);
@@ -4233,11 +4372,16 @@ struct image	*image_store(struct screen *, struct sixel_image *);
 int		 image_check_line(struct screen *, u_int, u_int);
 int		 image_check_area(struct screen *, u_int, u_int, u_int, u_int);
 int		 image_scroll_up(struct screen *, u_int);
+const char	*image_encode(struct image *, u_int, u_int, u_int, u_int, u_int,
+		     u_int, size_t *);
+void		 image_cache_stats(u_int *, u_int *, u_int *, size_t *);
+void		 image_stats(struct screen *, u_int *, size_t *);
 
 /* image-sixel.c */
 #define SIXEL_COLOUR_REGISTERS 1024
 struct sixel_image *sixel_parse(const char *, size_t, u_int, u_int, u_int);
 void		 sixel_free(struct sixel_image *);
+size_t		 sixel_size(struct sixel_image *);
 void		 sixel_log(struct sixel_image *);
 void		 sixel_size_in_cells(struct sixel_image *, u_int *, u_int *);
 struct sixel_image *sixel_scale(struct sixel_image *, u_int, u_int, u_int,
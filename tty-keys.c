@@ -34,16 +34,12 @@
 /*
  * Handle keys input from the outside terminal. tty_default_*_keys[] are a base
  * table of supported keys which are looked up in terminfo(5) and translated
- * into a ternary tree.
+ * into a ternary tree. The tree is shared by all terminals with the same keys.
  */
 
-static void	tty_keys_add1(struct tty_key **, const char *, key_code);
-static void	tty_keys_add(struct tty *, const char *, key_code);
-static void	tty_keys_free1(struct tty_key *);
-static struct tty_key *tty_keys_find1(struct tty_key *, const char *, size_t,
-		    size_t *);
-static struct tty_key *tty_keys_find(struct tty *, const char *, size_t,
-		    size_t *);
+static void	tty_keys_add(struct tty_key_tree *, const char *, key_code);
+static struct tty_key *tty_keys_find(struct tty_key_tree *, const char *,
+		    size_t, size_t *);
 static int	tty_keys_next1(struct tty *, const char *, size_t, key_code *,
 		    size_t *, int);
 static void	tty_keys_callback(int, short, void *);
@@ -62,16 +58,49 @@ static int	tty_keys_extended_device_attributes(struct tty *, const char *,
 static int	tty_keys_sync(struct tty *, const char *, size_t, size_t *);
 static int	tty_keys_palette(struct tty *, const char *, size_t, size_t *);
 
-/* A key tree entry. */
+/*
+ * A key tree entry. Entries are stored in an array and left, right and next
+ * are indexes into it. The root is always the first entry and nothing points
+ * back to it, so zero means no entry.
+ */
 struct tty_key {
 	char		 ch;
 	key_code	 key;
 
-	struct tty_key	*left;
-	struct tty_key	*right;
+	u_int		 left;
+	u_int		 right;
+
+	u_int		 next;
+};
+
+/*
+ * A key tree. Trees are found by the key strings they were built from (from
+ * terminfo(5) and user-keys) and shared by all terminals with the same keys. A
+ * few unused trees are kept for clients which attach again.
+ */
+struct tty_key_tree {
+	char				*id;
+	size_t				 idlen;
+	u_int				 references;
+
+	struct tty_key			*keys;
+	u_int				 used;
+	u_int				 size;
 
-	struct tty_key	*next;
+	TAILQ_ENTRY(tty_key_tree)	 unused_entry;
+	RB_ENTRY(tty_key_tree)		 entry;
 };
+RB_HEAD(tty_key_trees, tty_key_tree);
+static int	tty_key_tree_cmp(struct tty_key_tree *,
+		    struct tty_key_tree *);
+RB_GENERATE_STATIC(tty_key_trees, tty_key_tree, entry, tty_key_tree_cmp);
+static struct tty_key_trees tty_key_trees = RB_INITIALIZER(&tty_key_trees);
+
+#define TTY_KEY_TREES_UNUSED 4
+static TAILQ_HEAD(, tty_key_tree) tty_key_trees_unused =
+    TAILQ_HEAD_INITIALIZER(tty_key_trees_unused);
+static u_int	tty_key_trees_unused_count;
+static u_int	tty_key_trees_built;
 
 /* Default raw keys. */
 struct tty_default_key_raw {
@@ -430,63 +459,96 @@ static const struct tty_default_key_code tty_default_code_keys[] = {
 	{ TTYC_KUP7, KEYC_UP|KEYC_META|KEYC_IMPLIED_META|KEYC_CTRL },
 };
 
+/* Compare key trees. */
+static int
+tty_key_tree_cmp(struct tty_key_tree *kt1, struct tty_key_tree *kt2)
+{
+	if (kt1->idlen < kt2->idlen)
+		return (-1);
+	if (kt1->idlen > kt2->idlen)
+		return (1);
+	return (memcmp(kt1->id, kt2->id, kt1->idlen));
+}
+
+/* Add an entry to a tree, there must be space for it. */
+static u_int
+tty_keys_new(struct tty_key_tree *kt, char ch)
+{
+	struct tty_key	*tk;
+
+	tk = &kt->keys[kt->used];
+	tk->ch = ch;
+	tk->key = KEYC_UNKNOWN;
+	tk->left = tk->right = tk->next = 0;
+	return (kt->used++);
+}
+
 /* Add key to tree. */
 static void
-tty_keys_add(struct tty *tty, const char *s, key_code key)
+tty_keys_add(struct tty_key_tree *kt, const char *s, key_code key)
 {
 	struct tty_key	*tk;
 	size_t		 size;
 	const char	*keystr;
+	u_int		 n, *link;
+
+	if (*s == '\0')
+		return;
 
 	keystr = key_string_lookup_key(key, 1);
-	if ((tk = tty_keys_find(tty, s, strlen(s), &size)) == NULL) {
-		log_debug("new key %s: 0x%llx (%s)", s, key, keystr);
-		tty_keys_add1(&tty->key_tree, s, key);
-	} else {
+	if ((tk = tty_keys_find(kt, s, strlen(s), &size)) != NULL) {
 		log_debug("replacing key %s: 0x%llx (%s)", s, key, keystr);
 		tk->key = key;
+		return;
 	}
-}
-
-/* Add next node to the tree. */
-static void
-tty_keys_add1(struct tty_key **tkp, const char *s, key_code key)
-{
-	struct tty_key	*tk;
-
-	/* Allocate a tree entry if there isn't one already. */
-	tk = *tkp;
-	if (tk == NULL) {
-		tk = *tkp = xcalloc(1, sizeof *tk);
-		tk->ch = *s;
-		tk->key = KEYC_UNKNOWN;
-	}
-
-	/* Find the next entry. */
-	if (*s == tk->ch) {
-		/* Move forward in string. */
-		s++;
+	log_debug("new key %s: 0x%llx (%s)", s, key, keystr);
 
-		/* If this is the end of the string, no more is necessary. */
-		if (*s == '\0') {
-			tk->key = key;
-			return;
+	/*
+	 * Make sure there is space for one more entry before taking pointers
+	 * into the array, so they stay valid when an entry is added.
+	 */
+	n = 0;
+	for (;;) {
+		if (kt->used == kt->size) {
+			kt->size = (kt->size == 0) ? 64 : kt->size * 2;
+			kt->keys = xreallocarray(kt->keys, kt->size,
+			    sizeof *kt->keys);
 		}
+		if (kt->used == 0)
+			tty_keys_new(kt, *s);
+		tk = &kt->keys[n];
+
+		/* Find the next entry. */
+		if (*s == tk->ch) {
+			/* If this is the end of the string, we are done. */
+			if (*++s == '\0') {
+				tk->key = key;
+				return;
+			}
+			link = &tk->next;
+		} else if (*s < tk->ch)
+			link = &tk->left;
+		else
+			link = &tk->right;
 
-		/* Use the child tree for the next character. */
-		tkp = &tk->next;
-	} else {
-		if (*s < tk->ch)
-			tkp = &tk->left;
-		else if (*s > tk->ch)
-			tkp = &tk->right;
+		/* Add an entry if there isn't one and move to it. */
+		if (*link == 0)
+			*link = tty_keys_new(kt, *s);
+		n = *link;
 	}
+}
 
-	/* And recurse to add it. */
-	tty_keys_add1(tkp, s, key);
+/* Free a key tree. */
+static void
+tty_keys_free_tree(struct tty_key_tree *kt)
+{
+	RB_REMOVE(tty_key_trees, &tty_key_trees, kt);
+	free(kt->keys);
+	free(kt->id);
+	free(kt);
 }
 
-/* Initialise a key tree from the table. */
+/* Initialise a key tree from the table, or use an existing one. */
 void
 tty_keys_build(struct tty *tty)
 {
@@ -499,10 +561,50 @@ tty_keys_build(struct tty *tty)
 	union options_value			*ov;
 	char					 copy[16];
 	key_code				 key;
+	struct evbuffer				*id;
+	struct tty_key_tree			 find, *kt;
 
-	if (tty->key_tree != NULL)
+	/*
+	 * The default raw and xterm keys are always the same, so the tree
+	 * depends only on the strings from terminfo(5) and user-keys. Use them
+	 * to look for an existing tree.
+	 */
+	id = evbuffer_new();
+	if (id == NULL)
+		fatalx("out of memory");
+	for (i = 0; i < nitems(tty_default_code_keys); i++) {
+		s = tty_term_string(tty->term, tty_default_code_keys[i].code);
+		evbuffer_add(id, s, strlen(s) + 1);
+	}
+	o = options_get(global_options, "user-keys");
+	for (i = 0; o != NULL && i <= KEYC_NUSER; i++) {
+		ov = options_array_getv(o, "%u", i);
+		s = (ov == NULL) ? "" : ov->string;
+		evbuffer_add(id, s, strlen(s) + 1);
+	}
+	find.id = EVBUFFER_DATA(id);
+	find.idlen = EVBUFFER_LENGTH(id);
+	kt = RB_FIND(tty_key_trees, &tty_key_trees, &find);
+	if (kt != NULL) {
+		log_debug("%s: using existing key tree", tty->client->name);
+		if (kt->references++ == 0) {
+			TAILQ_REMOVE(&tty_key_trees_unused, kt, unused_entry);
+			tty_key_trees_unused_count--;
+		}
+		evbuffer_free(id);
 		tty_keys_free(tty);
-	tty->key_tree = NULL;
+		tty->key_tree = kt;
+		return;
+	}
+
+	kt = xcalloc(1, sizeof *kt);
+	kt->idlen = EVBUFFER_LENGTH(id);
+	kt->id = xmalloc(kt->idlen);
+	memcpy(kt->id, EVBUFFER_DATA(id), kt->idlen);
+	kt->references = 1;
+	evbuffer_free(id);
+	RB_INSERT(tty_key_trees, &tty_key_trees, kt);
+	tty_key_trees_built++;
 
 	for (i = 0; i < nitems(tty_default_xterm_keys); i++) {
 		tdkx = &tty_default_xterm_keys[i];
@@ -511,7 +613,7 @@ tty_keys_build(struct tty *tty)
 			copy[strcspn(copy, "_")] = '0' + j;
 
 			key = tdkx->key|tty_default_xterm_modifiers[j];
-			tty_keys_add(tty, copy, key);
+			tty_keys_add(kt, copy, key);
 		}
 	}
 	for (i = 0; i < nitems(tty_default_raw_keys); i++) {
@@ -519,88 +621,138 @@ tty_keys_build(struct tty *tty)
 
 		s = tdkr->string;
 		if (*s != '\0')
-			tty_keys_add(tty, s, tdkr->key);
+			tty_keys_add(kt, s, tdkr->key);
 	}
 	for (i = 0; i < nitems(tty_default_code_keys); i++) {
 		tdkc = &tty_default_code_keys[i];
 
 		s = tty_term_string(tty->term, tdkc->code);
 		if (*s != '\0')
-			tty_keys_add(tty, s, tdkc->key);
+			tty_keys_add(kt, s, tdkc->key);
 
 	}
 
-	o = options_get(global_options, "user-keys");
 	if (o != NULL) {
 		for (i = 0; i <= KEYC_NUSER; i++) {
 			ov = options_array_getv(o, "%u", i);
 			if (ov != NULL)
-				tty_keys_add(tty, ov->string, KEYC_USER + i);
+				tty_keys_add(kt, ov->string, KEYC_USER + i);
 		}
 	}
+	log_debug("%s: built key tree with %u entries", tty->client->name,
+	    kt->used);
+
+	tty_keys_free(tty);
+	tty->key_tree = kt;
 }
 
-/* Free the entire key tree. */
+/* Release the key tree, keeping it for a while if it is no longer used. */
 void
 tty_keys_free(struct tty *tty)
 {
-	tty_keys_free1(tty->key_tree);
+	struct tty_key_tree	*kt = tty->key_tree;
+
+	if (kt == NULL)
+		return;
+	tty->key_tree = NULL;
+	if (--kt->references != 0)
+		return;
+
+	TAILQ_INSERT_TAIL(&tty_key_trees_unused, kt, unused_entry);
+	if (++tty_key_trees_unused_count > TTY_KEY_TREES_UNUSED) {
+		kt = TAILQ_FIRST(&tty_key_trees_unused);
+		TAILQ_REMOVE(&tty_key_trees_unused, kt, unused_entry);
+		tty_key_trees_unused_count--;
+		tty_keys_free_tree(kt);
+	}
 }
 
-/* Free a single key. */
-static void
-tty_keys_free1(struct tty_key *tk)
+/* Get the number of key trees built. */
+u_int
+tty_keys_trees_built(void)
 {
-	if (tk->next != NULL)
-		tty_keys_free1(tk->next);
-	if (tk->left != NULL)
-		tty_keys_free1(tk->left);
-	if (tk->right != NULL)
-		tty_keys_free1(tk->right);
-	free(tk);
+	return (tty_key_trees_built);
 }
 
 /* Lookup a key in the tree. */
 static struct tty_key *
-tty_keys_find(struct tty *tty, const char *buf, size_t len, size_t *size)
+tty_keys_find(struct tty_key_tree *kt, const char *buf, size_t len,
+    size_t *size)
 {
-	*size = 0;
-	return (tty_keys_find1(tty->key_tree, buf, len, size));
-}
+	struct tty_key	*tk;
+	u_int		 n = 0;
 
-/* Find the next node. */
-static struct tty_key *
-tty_keys_find1(struct tty_key *tk, const char *buf, size_t len, size_t *size)
-{
-	/* If no data, no match. */
-	if (len == 0)
+	*size = 0;
+	if (kt == NULL || kt->used == 0)
 		return (NULL);
+	while (len != 0) {
+		tk = &kt->keys[n];
+
+		/* Pick the next in the sequence. */
+		if (tk->ch == *buf) {
+			/* Move forward in the string. */
+			buf++; len--;
+			(*size)++;
+
+			/* At the end of the string, return this entry. */
+			if (len == 0 ||
+			    (tk->next == 0 && tk->key != KEYC_UNKNOWN))
+				return (tk);
+
+			/* Move into the next tree for the next character. */
+			n = tk->next;
+		} else if (*buf < tk->ch)
+			n = tk->left;
+		else
+			n = tk->right;
 
-	/* If the node is NULL, this is the end of the tree. No match. */
-	if (tk == NULL)
-		return (NULL);
+		/* If there is no entry, this is the end of the tree. */
+		if (n == 0)
+			return (NULL);
+	}
+	return (NULL);
+}
 
-	/* Pick the next in the sequence. */
-	if (tk->ch == *buf) {
-		/* Move forward in the string. */
-		buf++; len--;
-		(*size)++;
+/*
+ * Get the size of the block of text at the start of the buffer which can be
+ * passed to the pane in one go rather than key by key. This is anything up to
+ * the next escape in a bracketed paste, or a run of at least two printable
+ * characters which are not part of any key and are not bound.
+ */
+static size_t
+tty_keys_paste_block(struct tty *tty, const char *buf, size_t len)
+{
+	struct client	*c = tty->client;
+	const char	*end;
+	size_t		 n, size;
 
-		/* At the end of the string, return the current node. */
-		if (len == 0 || (tk->next == NULL && tk->key != KEYC_UNKNOWN))
-			return (tk);
+	if (*buf == '\033')
+		return (0);
 
-		/* Move into the next tree for the following character. */
-		tk = tk->next;
-	} else {
-		if (*buf < tk->ch)
-			tk = tk->left;
-		else if (*buf > tk->ch)
-			tk = tk->right;
+	if (tty->flags & TTY_BRACKETPASTE) {
+		if ((~c->flags & CLIENT_BRACKETPASTING) ||
+		    !server_client_can_paste_block(c, 1))
+			return (0);
+		if ((end = memchr(buf, '\033', len)) != NULL)
+			return (end - buf);
+		return (len);
 	}
 
-	/* Move to the next in the tree. */
-	return (tty_keys_find1(tk, buf, len, size));
+	if (len < 2 || !server_client_can_paste_block(c, 0))
+		return (0);
+	for (n = 0; n < len; n++) {
+		if (buf[n] < 0x20 || buf[n] > 0x7e)
+			break;
+		if ((cc_t)buf[n] == tty->tio.c_cc[VERASE])
+			break;
+		if (tty_keys_find(tty->key_tree, buf + n, 1, &size) != NULL)
+			break;
+		if (server_client_key_is_bound(c, (u_char)buf[n]))
+			break;
+	}
+	if (n < 2)
+		return (0);
+	return (n);
 }
 
 static int
@@ -624,19 +776,20 @@ tty_keys_next1(struct tty *tty, const char *buf, size_t len, key_code *key,
 	struct utf8_data	 ud;
 	enum utf8_state		 more;
 	utf8_char		 uc;
-	u_int			 i;
+	u_int			 i, n;
 
 	log_debug("%s: next key is %zu (%.*s) (expired=%d)", c->name, len,
 	    (int)len, buf, expired);
 
 	/* Is this a known key? */
-	tk = tty_keys_find(tty, buf, len, size);
+	tk = tty_keys_find(tty->key_tree, buf, len, size);
 	if (tk != NULL && tk->key != KEYC_UNKNOWN) {
-		tk1 = tk;
-		do
+		n = tk - tty->key_tree->keys;
+		do {
+			tk1 = &tty->key_tree->keys[n];
 			log_debug("%s: keys in list: %#llx", c->name, tk1->key);
-		while ((tk1 = tk1->next) != NULL);
-		if (tk->next != NULL && !expired)
+		} while ((n = tk1->next) != 0);
+		if (tk->next != 0 && !expired)
 			return (1);
 		*key = tk->key;
 		if ((*key & KEYC_MASK_KEY) == KEYC_PASTE_START)
@@ -761,6 +914,12 @@ tty_keys_next(struct tty *tty)
 		return (0);
 	log_debug("%s: keys are %zu (%.*s)", c->name, len, (int)len, buf);
 
+	/* Is this a block of pasted text? */
+	if ((size = tty_keys_paste_block(tty, buf, len)) != 0) {
+		key = KEYC_NONE;
+		goto complete_key;
+	}
+
 	/* Is this a clipboard response? */
 	switch (tty_keys_clipboard(tty, buf, len, &size)) {
 	case 0:		/* yes */
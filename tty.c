@@ -1024,12 +1024,13 @@ tty_window_offset1(struct tty *tty, u_int *ox, u_int *oy, u_int *sx, u_int *sy)
 void
 tty_update_window_offset(struct window *w)
 {
+	struct winlink	*wl;
 	struct client	*c;
 
-	TAILQ_FOREACH(c, &clients, entry) {
-		if (c->session != NULL &&
-		    c->session->curw != NULL &&
-		    c->session->curw->window == w)
+	TAILQ_FOREACH(wl, &w->winlinks, wentry) {
+		if (wl->session->curw != wl)
+			continue;
+		TAILQ_FOREACH(c, &wl->session->clients, sentry)
 			tty_update_client_offset(c);
 	}
 }
@@ -2163,8 +2164,7 @@ tty_cmd_sixelimage(struct tty *tty, const struct tty_ctx *ctx)
 {
 	struct image		*im = ctx->image;
 	struct sixel_image	*si = im->data;
-	struct sixel_image	*new;
-	char			*data;
+	const char		*data;
 	size_t			 size;
 	u_int			 cx = ctx->ocx, cy = ctx->ocy, sx, sy;
 	u_int			 i, j, x, y, rx, ry;
@@ -2183,14 +2183,11 @@ tty_cmd_sixelimage(struct tty *tty, const struct tty_ctx *ctx)
 	log_debug("%s: clamping to %u,%u-%u,%u", __func__, i, j, rx, ry);
 
 	if (fallback == 1) {
-		data = xstrdup(im->fallback);
+		data = im->fallback;
 		size = strlen(data);
 	} else {
-		new = sixel_scale(si, tty->xpixel, tty->ypixel, i, j, rx, ry, 0);
-		if (new == NULL)
-			return;
-
-		data = sixel_print(new, si, &size);
+		data = image_encode(im, tty->xpixel, tty->ypixel, i, j, rx, ry,
+		    &size);
 	}
 	if (data != NULL) {
 		log_debug("%s: %zu bytes: %s", __func__, size, data);
@@ -2201,11 +2198,7 @@ tty_cmd_sixelimage(struct tty *tty, const struct tty_ctx *ctx)
 		tty->flags |= TTY_NOBLOCK;
 		tty_add(tty, data, size);
 		tty_invalidate(tty);
-		free(data);
 	}
-
-	if (fallback == 0)
-		sixel_free(new);
 }
 #endif
 
@@ -133,6 +133,53 @@ window_buffer_free_item(struct window_buffer_itemdata *item)
 	free(item);
 }
 
+/* Events which change the items in the tree. */
+static const char *window_buffer_events[] = {
+	"paste-buffer-changed",
+	"paste-buffer-deleted",
+	NULL
+};
+
+static struct format_tree *
+window_buffer_format_create(struct window_buffer_modedata *data,
+    struct paste_buffer *pb)
+{
+	struct format_tree	*ft;
+	struct session		*s = NULL;
+	struct winlink		*wl = NULL;
+	struct window_pane	*wp = NULL;
+
+	if (cmd_find_valid_state(&data->fs)) {
+		s = data->fs.s;
+		wl = data->fs.wl;
+		wp = data->fs.wp;
+	}
+
+	ft = format_create(NULL, NULL, FORMAT_NONE, 0);
+	format_defaults(ft, NULL, s, wl, wp);
+	format_defaults_paste_buffer(ft, pb);
+	return (ft);
+}
+
+/* Get the text for an item again when the tree is updated. */
+static char *
+window_buffer_get_text(void *modedata, void *itemdata)
+{
+	struct window_buffer_modedata	*data = modedata;
+	struct window_buffer_itemdata	*item = itemdata;
+	struct paste_buffer		*pb;
+	struct format_tree		*ft;
+	char				*text;
+
+	pb = paste_get_name(item->name);
+	if (pb == NULL)
+		return (NULL);
+	ft = window_buffer_format_create(data, pb);
+	text = format_expand(ft, data->format);
+	format_free(ft);
+	return (text);
+}
+
 static void
 window_buffer_build(void *modedata, struct sort_criteria *sort_crit,
     __unused uint64_t *tag, const char *filter)
@@ -143,9 +190,6 @@ window_buffer_build(void *modedata, struct sort_criteria *sort_crit,
 	struct paste_buffer		*pb, **l;
 	char				*text, *cp;
 	struct format_tree		*ft;
-	struct session			*s = NULL;
-	struct winlink			*wl = NULL;
-	struct window_pane		*wp = NULL;
 
 	for (i = 0; i < data->item_size; i++)
 		window_buffer_free_item(data->item_list[i]);
@@ -161,21 +205,13 @@ window_buffer_build(void *modedata, struct sort_criteria *sort_crit,
 		item->order = paste_buffer_order(l[i]);
 	}
 
-	if (cmd_find_valid_state(&data->fs)) {
-		s = data->fs.s;
-		wl = data->fs.wl;
-		wp = data->fs.wp;
-	}
-
 	for (i = 0; i < data->item_size; i++) {
 		item = data->item_list[i];
 
 		pb = paste_get_name(item->name);
 		if (pb == NULL)
 			continue;
-		ft = format_create(NULL, NULL, FORMAT_NONE, 0);
-		format_defaults(ft, NULL, s, wl, wp);
-		format_defaults_paste_buffer(ft, pb);
+		ft = window_buffer_format_create(data, pb);
 
 		if (filter != NULL) {
 			cp = format_expand(ft, filter);
@@ -392,6 +428,7 @@ window_buffer_init(struct window_mode_entry *wme,
 	    window_buffer_draw, window_buffer_search, window_buffer_menu, NULL,
 	    window_buffer_get_key, NULL, window_buffer_sort, window_buffer_help,
 	    data, window_buffer_menu_items, &s);
+	mode_tree_watch(data->data, window_buffer_events);
 	mode_tree_zoom(data->data, args);
 
 	mode_tree_build(data->data);
@@ -440,7 +477,7 @@ window_buffer_update(struct window_mode_entry *wme)
 {
 	struct window_buffer_modedata	*data = wme->data;
 
-	mode_tree_build(data->data);
+	mode_tree_update(data->data, window_buffer_get_text);
 	mode_tree_draw(data->data);
 	window_buffer_draw_waiting(data);
 	data->wp->flags |= PANE_REDRAW;
@@ -212,6 +212,28 @@ window_client_free_item(struct window_client_itemdata *item)
 	free(item);
 }
 
+/* Events which change the items in the tree. */
+static const char *window_client_events[] = {
+	"client-attached",
+	"client-closed",
+	"client-detached",
+	"client-session-changed",
+	NULL
+};
+
+/* Get the text for an item again when the tree is updated. */
+static char *
+window_client_get_text(void *modedata, void *itemdata)
+{
+	struct window_client_modedata	*data = modedata;
+	struct window_client_itemdata	*item = itemdata;
+	struct client			*c = item->c;
+
+	if (c->session == NULL || (c->flags & CLIENT_UNATTACHEDFLAGS))
+		return (NULL);
+	return (format_single(NULL, data->format, c, NULL, NULL, NULL));
+}
+
 static void
 window_client_build(void *modedata, struct sort_criteria *sort_crit,
     __unused uint64_t *tag, const char *filter)
@@ -457,6 +479,7 @@ window_client_init(struct window_mode_entry *wme,
 	    window_client_draw, NULL, window_client_menu, NULL,
 	    window_client_get_key, NULL, window_client_sort,
 	    window_client_help, data, window_client_menu_items, &s);
+	mode_tree_watch(data->data, window_client_events);
 	mode_tree_zoom(data->data, args);
 
 	if (data->preview_is_info)
@@ -505,7 +528,7 @@ window_client_update(struct window_mode_entry *wme)
 {
 	struct window_client_modedata	*data = wme->data;
 
-	mode_tree_build(data->data);
+	mode_tree_update(data->data, window_client_get_text);
 	mode_tree_draw(data->data);
 	data->wp->flags |= PANE_REDRAW;
 }
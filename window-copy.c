@@ -399,6 +399,9 @@ window_copy_clone_screen(struct screen *src, struct screen *hint, u_int *cx,
 
 	dst = xcalloc(1, sizeof *dst);
 
+	/* The whole history is copied so must be reflowed first. */
+	grid_reflow_history(src->grid, 0);
+
 	sy = screen_hsize(src) + screen_size_y(src);
 	if (trim) {
 		while (sy > screen_hsize(src)) {
@@ -442,6 +445,7 @@ window_copy_clone_screen(struct screen *src, struct screen *hint, u_int *cx,
 		grid_wrap_position(dst->grid, *cx, *cy, &wx, &wy);
 	screen_resize_cursor(dst, screen_size_x(hint), screen_size_y(hint), 1,
 	    0, 0);
+	grid_reflow_history(dst->grid, 0);
 	if (reflow)
 		grid_unwrap_position(dst->grid, cx, cy, wx, wy);
 
@@ -1226,6 +1230,7 @@ window_copy_resize(struct window_mode_entry *wme, u_int sx, u_int sy)
 	if (reflow)
 		grid_wrap_position(gd, cx, cy, &wx, &wy);
 	screen_resize_cursor(data->backing, sx, sy, 1, 0, 0);
+	grid_reflow_history(gd, 0);
 	if (reflow)
 		grid_unwrap_position(gd, &cx, &cy, wx, wy);
 
@@ -73,6 +73,7 @@ struct window_switch_itemdata {
 
 	uint64_t		 tag;
 	char			*text;
+	struct fuzzy_text	*scanned;
 	bitstr_t		*match;
 
 	u_int			 score;
@@ -97,6 +98,7 @@ struct window_switch_modedata {
 
 	struct window_switch_itemdata	**matches;
 	u_int				  matches_size;
+	char				 *matches_filter;
 
 	u_int				  current;
 	u_int				  offset;
@@ -106,6 +108,7 @@ static void
 window_switch_free_item(struct window_switch_itemdata *item)
 {
 	free(item->match);
+	fuzzy_text_free(item->scanned);
 	free(item->text);
 	free(item);
 }
@@ -181,12 +184,62 @@ window_switch_compare(const void *a0, const void *b0)
 }
 
 static void
-window_switch_build(struct window_switch_modedata *data)
+window_switch_filter(struct window_switch_modedata *data)
 {
-	struct window_switch_itemdata	 *item, **m = NULL;
+	struct window_switch_itemdata	 *item, **list, **m;
+	struct fuzzy_pattern		 *fp = NULL;
 	const char			 *f = data->filter;
-	u_int				  ns, nw, i, n = 0, order = 0;
+	u_int				  size, i, n = 0;
 	u_int				  sx = screen_size_x(&data->screen);
+
+	/*
+	 * If the filter has only been extended so it cannot match anything
+	 * the last one did not, look only at the last matches.
+	 */
+	if (data->matches_filter != NULL &&
+	    fuzzy_pattern_narrows(data->matches_filter, f)) {
+		list = data->matches;
+		size = data->matches_size;
+	} else {
+		list = data->item_list;
+		size = data->item_size;
+	}
+	m = xreallocarray(NULL, size + 1, sizeof *m);
+
+	if (*f != '\0')
+		fp = fuzzy_pattern_create(f);
+	for (i = 0; i < size; i++) {
+		item = list[i];
+		free(item->match);
+		item->match = NULL;
+		if (fp == NULL) {
+			item->score = 0;
+			m[n++] = item;
+			continue;
+		}
+
+		if (item->scanned == NULL)
+			item->scanned = fuzzy_text_create(item->text);
+		item->match = fuzzy_match_text(fp, item->scanned, sx,
+		    &item->score);
+		if (item->match != NULL)
+			m[n++] = item;
+	}
+	fuzzy_pattern_free(fp);
+	qsort(m, n, sizeof *m, window_switch_compare);
+
+	free(data->matches);
+	data->matches = m;
+	data->matches_size = n;
+
+	free(data->matches_filter);
+	data->matches_filter = xstrdup(f);
+}
+
+static void
+window_switch_build(struct window_switch_modedata *data)
+{
+	u_int				  ns, nw, i, order = 0;
 	struct session			**sl;
 	struct winlink			**wl;
 	struct sort_criteria		  sort_crit;
@@ -213,25 +266,9 @@ window_switch_build(struct window_switch_modedata *data)
 		break;
 	}
 
-	for (i = 0; i < data->item_size; i++) {
-		item = data->item_list[i];
-		if (*f == '\0') {
-			m = xreallocarray(m, n + 1, sizeof *m);
-			m[n++] = item;
-			continue;
-		}
-
-		item->match = fuzzy_match(f, item->text, sx, &item->score);
-		if (item->match == NULL)
-			continue;
-		m = xreallocarray(m, n + 1, sizeof *m);
-		m[n++] = item;
-	}
-	qsort(m, n, sizeof *m, window_switch_compare);
-
-	free(data->matches);
-	data->matches = m;
-	data->matches_size = n;
+	free(data->matches_filter);
+	data->matches_filter = NULL;
+	window_switch_filter(data);
 }
 
 static u_int
@@ -405,6 +442,7 @@ window_switch_free(struct window_mode_entry *wme)
 	free(data->item_list);
 
 	free(data->matches);
+	free(data->matches_filter);
 	free(data->filter);
 	prompt_free(data->prompt);
 	free(data->format);
@@ -499,7 +537,7 @@ window_switch_prompt_callback(void *arg, const char *s,
 
 	free(data->filter);
 	data->filter = xstrdup(s);
-	window_switch_build(data);
+	window_switch_filter(data);
 	data->current = 0;
 	data->offset = 0;
 
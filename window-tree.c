@@ -252,6 +252,73 @@ window_tree_pull_item(struct window_tree_itemdata *item, struct session **sp,
 	}
 }
 
+/* Events which change the items in the tree. */
+static const char *window_tree_events[] = {
+	"pane-created",
+	"pane-moved",
+	"session-closed",
+	"session-created",
+	"session-renamed",
+	"session-windows-changed",
+	"window-layout-changed",
+	"window-linked",
+	"window-renamed",
+	"window-unlinked",
+	NULL
+};
+
+/* Expand the format for an item. */
+static char *
+window_tree_format_item(struct window_tree_modedata *data,
+    enum window_tree_type type, struct session *s, struct winlink *wl,
+    struct window_pane *wp)
+{
+	struct format_tree	*ft;
+	uint64_t		 tag = FORMAT_NONE;
+	char			*text;
+
+	switch (type) {
+	case WINDOW_TREE_NONE:
+		return (NULL);
+	case WINDOW_TREE_SESSION:
+		wl = s->curw;
+		if (wl != NULL && wl->window != NULL &&
+		    wl->window->active != NULL)
+			tag = FORMAT_PANE|wl->window->active->id;
+		ft = format_create(NULL, NULL, tag, 0);
+		format_defaults(ft, NULL, s, NULL, NULL);
+		break;
+	case WINDOW_TREE_WINDOW:
+		if (wl->window != NULL && wl->window->active != NULL)
+			tag = FORMAT_PANE|wl->window->active->id;
+		ft = format_create(NULL, NULL, tag, 0);
+		format_defaults(ft, NULL, s, wl, NULL);
+		break;
+	case WINDOW_TREE_PANE:
+		ft = format_create(NULL, NULL, FORMAT_PANE|wp->id, 0);
+		format_defaults(ft, NULL, s, wl, wp);
+		break;
+	}
+	text = format_expand(ft, data->format);
+	format_free(ft);
+	return (text);
+}
+
+/* Get the text for an item again when the tree is updated. */
+static char *
+window_tree_get_text(void *modedata, void *itemdata)
+{
+	struct window_tree_itemdata	*item = itemdata;
+	struct session			*s;
+	struct winlink			*wl;
+	struct window_pane		*wp;
+
+	window_tree_pull_item(item, &s, &wl, &wp);
+	if (s == NULL)
+		return (NULL);
+	return (window_tree_format_item(modedata, item->type, s, wl, wp));
+}
+
 static struct window_tree_itemdata *
 window_tree_add_item(struct window_tree_modedata *data)
 {
@@ -278,7 +345,6 @@ window_tree_build_pane(struct session *s, struct winlink *wl,
 	struct mode_tree_item		*mti;
 	char				*name, *text;
 	u_int				 idx;
-	struct format_tree		*ft;
 
 	window_pane_index(wp, &idx);
 
@@ -288,11 +354,8 @@ window_tree_build_pane(struct session *s, struct winlink *wl,
 	item->winlink = wl->idx;
 	item->pane = wp->id;
 
-	ft = format_create(NULL, NULL, FORMAT_PANE|wp->id, 0);
-	format_defaults(ft, NULL, s, wl, wp);
-	text = format_expand(ft, data->format);
+	text = window_tree_format_item(data, item->type, s, wl, wp);
 	xasprintf(&name, "%u", idx);
-	format_free(ft);
 
 	mti = mode_tree_add(data->data, parent, item, (uint64_t)wp, name, text,
 	    -1);
@@ -330,8 +393,6 @@ window_tree_build_window(struct session *s, struct winlink *wl,
 	struct window_pane		**l;
 	u_int				 n, i, found;
 	int				 expanded;
-	struct format_tree		*ft;
-	uint64_t			 tag = FORMAT_NONE;
 
 	item = window_tree_add_item(data);
 	item->type = WINDOW_TREE_WINDOW;
@@ -339,13 +400,8 @@ window_tree_build_window(struct session *s, struct winlink *wl,
 	item->winlink = wl->idx;
 	item->pane = -1;
 
-	if (wl->window != NULL && wl->window->active != NULL)
-		tag = FORMAT_PANE|wl->window->active->id;
-	ft = format_create(NULL, NULL, tag, 0);
-	format_defaults(ft, NULL, s, wl, NULL);
-	text = format_expand(ft, data->format);
+	text = window_tree_format_item(data, item->type, s, wl, NULL);
 	xasprintf(&name, "%u", wl->idx);
-	format_free(ft);
 
 	if (data->type == WINDOW_TREE_SESSION ||
 	    data->type == WINDOW_TREE_WINDOW)
@@ -385,11 +441,9 @@ window_tree_build_session(struct session *s, void *modedata,
 	struct window_tree_itemdata	*item;
 	struct mode_tree_item		*mti;
 	char				*text;
-	struct winlink			*wl = s->curw, **l;
+	struct winlink			**l;
 	u_int				 n, i, empty;
 	int				 expanded;
-	struct format_tree		*ft;
-	uint64_t			 tag = FORMAT_NONE;
 
 	item = window_tree_add_item(data);
 	item->type = WINDOW_TREE_SESSION;
@@ -397,12 +451,7 @@ window_tree_build_session(struct session *s, void *modedata,
 	item->winlink = -1;
 	item->pane = -1;
 
-	if (wl != NULL && wl->window != NULL && wl->window->active != NULL)
-		tag = FORMAT_PANE|wl->window->active->id;
-	ft = format_create(NULL, NULL, tag, 0);
-	format_defaults(ft, NULL, s, NULL, NULL);
-	text = format_expand(ft, data->format);
-	format_free(ft);
+	text = window_tree_format_item(data, item->type, s, NULL, NULL);
 
 	if (data->type == WINDOW_TREE_SESSION)
 		expanded = 0;
@@ -920,8 +969,7 @@ window_tree_search(__unused void *modedata, void *itemdata, const char *ss,
 	struct session			*s;
 	struct winlink			*wl;
 	struct window_pane		*wp;
-	char				*cmd;
-	int				 retval;
+	const char			*cmd;
 
 	window_tree_pull_item(item, &s, &wl, &wp);
 
@@ -943,17 +991,12 @@ window_tree_search(__unused void *modedata, void *itemdata, const char *ss,
 	case WINDOW_TREE_PANE:
 		if (s == NULL || wl == NULL || wp == NULL)
 			break;
-		cmd = osdep_get_name(wp->fd, wp->tty);
-		if (cmd == NULL || *cmd == '\0') {
-			free(cmd);
+		cmd = get_pane_command(wp);
+		if (cmd == NULL || *cmd == '\0')
 			return (0);
-		}
 		if (icase)
-			retval = (strcasestr(cmd, ss) != NULL);
-		else
-			retval = (strstr(cmd, ss) != NULL);
-		free(cmd);
-		return (retval);
+			return (strcasestr(cmd, ss) != NULL);
+		return (strstr(cmd, ss) != NULL);
 	}
 	return (0);
 }
@@ -1139,6 +1182,7 @@ window_tree_init(struct window_mode_entry *wme,
 	    window_tree_draw, window_tree_search, window_tree_menu, NULL,
 	    window_tree_get_key, window_tree_swap, window_tree_sort,
 	    window_tree_help, data, window_tree_menu_items, &s);
+	mode_tree_watch(data->data, window_tree_events);
 	mode_tree_zoom(data->data, args);
 	mode_tree_view_name(data->data, "preview");
 
@@ -1195,7 +1239,7 @@ window_tree_update(struct window_mode_entry *wme)
 {
 	struct window_tree_modedata	*data = wme->data;
 
-	mode_tree_build(data->data);
+	mode_tree_update(data->data, window_tree_get_text);
 	mode_tree_draw(data->data);
 	data->wp->flags |= PANE_REDRAW;
 }
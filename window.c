@@ -62,6 +62,15 @@ static u_int	next_window_pane_id;
 static u_int	next_window_id;
 static u_int	next_active_point;
 
+/* Panes with history waiting to be reflowed. */
+static TAILQ_HEAD(, window_pane) window_pane_reflows =
+    TAILQ_HEAD_INITIALIZER(window_pane_reflows);
+static struct event	window_pane_reflow_timer;
+
+/* Lines reflowed at a time and time taken before giving way to other events. */
+#define WINDOW_PANE_REFLOW_LINES 2000
+#define WINDOW_PANE_REFLOW_SLICE 10000
+
 struct window_pane_input_data {
 	struct cmdq_item	*item;
 	u_int			 wp;
@@ -73,6 +82,7 @@ static struct window_pane *window_pane_create(struct window *, u_int, u_int,
 static void	window_pane_destroy(struct window_pane *);
 static void	window_pane_free(struct window_pane *);
 static void	window_pane_scrollbar_timer(int, short, void *);
+static void	window_pane_reflow_cancel(struct window_pane *);
 static void	window_pane_full_size_offset(struct window_pane *, int *, int *,
 		    u_int *, u_int *);
 
@@ -1380,10 +1390,12 @@ window_pane_create(struct window *w, u_int sx, u_int sy, u_int hlimit)
 	RB_INSERT(window_pane_tree, &all_window_panes, wp);
 
 	wp->fd = -1;
+	wp->proc.pgrp = -1;
 
 	TAILQ_INIT(&wp->modes);
 
 	TAILQ_INIT (&wp->resize_queue);
+	TAILQ_INIT(&wp->pastes);
 
 	wp->sx = sx;
 	wp->sy = sy;
@@ -1505,6 +1517,8 @@ window_pane_destroy(struct window_pane *wp)
 
 	window_pane_free_modes(wp);
 	screen_write_clear_dirty(wp);
+	paste_cancel(wp);
+	window_pane_reflow_cancel(wp);
 
 	if (wp->fd != -1) {
 #ifdef HAVE_UTEMPTER
@@ -1545,6 +1559,8 @@ window_pane_free(struct window_pane *wp)
 	log_debug("pane %%%u freed (%d references)", wp->id, wp->references);
 
 	free(wp->searchstr);
+	free(wp->proc.name);
+	free(wp->proc.cwd);
 
 	screen_free(&wp->status_screen);
 	screen_free(&wp->base);
@@ -1578,6 +1594,7 @@ window_pane_read_callback(__unused struct bufferevent *bufev, void *data)
 	}
 
 	log_debug("%%%u has %zu bytes", wp->id, size);
+	wp->proc.flags |= PANE_PROC_STALE;
 	TAILQ_FOREACH(c, &clients, entry) {
 		if (c->session != NULL && (c->flags & CLIENT_CONTROL))
 			control_write_output(c, wp);
@@ -1586,6 +1603,15 @@ window_pane_read_callback(__unused struct bufferevent *bufev, void *data)
 	bufferevent_disable(wp->event, EV_READ);
 }
 
+static void
+window_pane_write_callback(__unused struct bufferevent *bufev, void *data)
+{
+	struct window_pane	*wp = data;
+
+	if (!TAILQ_EMPTY(&wp->pastes))
+		paste_send_next(wp);
+}
+
 static void
 window_pane_error_callback(__unused struct bufferevent *bufev,
     __unused short what, void *data)
@@ -1605,9 +1631,10 @@ window_pane_set_event(struct window_pane *wp)
 	setblocking(wp->fd, 0);
 
 	wp->event = bufferevent_new(wp->fd, window_pane_read_callback,
-	    NULL, window_pane_error_callback, wp);
+	    window_pane_write_callback, window_pane_error_callback, wp);
 	if (wp->event == NULL)
 		fatalx("out of memory");
+	bufferevent_setwatermark(wp->event, EV_WRITE, PASTE_CHUNK_SIZE / 2, 0);
 	wp->ictx = input_init(wp, wp->event, &wp->palette, NULL);
 
 	bufferevent_enable(wp->event, EV_READ|EV_WRITE);
@@ -1652,6 +1679,8 @@ window_pane_resize(struct window_pane *wp, u_int sx, u_int sy)
 
 	log_debug("%s: %%%u resize %ux%u", __func__, wp->id, sx, sy);
 	screen_resize(&wp->base, sx, sy, wp->base.saved_grid == NULL);
+	if (wp->base.grid->reflow_lines != 0)
+		window_pane_reflow_queue(wp);
 
 	wme = TAILQ_FIRST(&wp->modes);
 	if (wme != NULL && wme->mode->resize != NULL)
@@ -1957,6 +1986,7 @@ window_pane_copy_paste(struct window_pane *wp, char *buf, size_t len)
 		    window_pane_is_visible(loop) &&
 		    options_get_number(loop->options, "synchronize-panes")) {
 			log_debug("%s: %.*s", __func__, (int)len, buf);
+			paste_flush(loop);
 			bufferevent_write(loop->event, buf, len);
 		}
 	}
@@ -1991,6 +2021,7 @@ window_pane_paste(struct window_pane *wp, key_code key, char *buf, size_t len)
 		return;
 
 	log_debug("%s: %.*s", __func__, (int)len, buf);
+	paste_flush(wp);
 	bufferevent_write(wp->event, buf, len);
 
 	if (options_get_number(wp->options, "synchronize-panes"))
@@ -2034,6 +2065,95 @@ window_pane_key(struct window_pane *wp, struct client *c, struct session *s,
 	return (0);
 }
 
+/* Is this pane visible to any attached client? */
+static int
+window_pane_reflow_visible(struct window_pane *wp)
+{
+	struct winlink	*wl;
+
+	if (!window_pane_is_visible(wp))
+		return (0);
+	TAILQ_FOREACH(wl, &wp->window->winlinks, wentry) {
+		if (wl->session->attached != 0 && wl->session->curw == wl)
+			return (1);
+	}
+	return (0);
+}
+
+/*
+ * Reflow the history of waiting panes until the time slice is used up,
+ * visible panes first.
+ */
+static void
+window_pane_reflow_callback(__unused int fd, __unused short events,
+    __unused void *arg)
+{
+	struct window_pane	*wp;
+	struct timeval		 start, now, tv = { 0 };
+
+	gettimeofday(&start, NULL);
+	for (;;) {
+		TAILQ_FOREACH(wp, &window_pane_reflows, rentry) {
+			if (window_pane_reflow_visible(wp))
+				break;
+		}
+		if (wp == NULL && (wp = TAILQ_FIRST(&window_pane_reflows)) == NULL)
+			break;
+
+		if (grid_reflow_history(wp->base.grid,
+		    WINDOW_PANE_REFLOW_LINES) == 0)
+			window_pane_reflow_cancel(wp);
+		wp->flags |= PANE_REDRAWSCROLLBAR;
+
+		gettimeofday(&now, NULL);
+		timersub(&now, &start, &now);
+		if (now.tv_sec != 0 || now.tv_usec >= WINDOW_PANE_REFLOW_SLICE)
+			break;
+	}
+	if (!TAILQ_EMPTY(&window_pane_reflows))
+		evtimer_add(&window_pane_reflow_timer, &tv);
+}
+
+/* Queue a pane to have the rest of its history reflowed when idle. */
+void
+window_pane_reflow_queue(struct window_pane *wp)
+{
+	struct timeval	tv = { 0 };
+
+	if (~wp->flags & PANE_REFLOWQUEUED) {
+		TAILQ_INSERT_TAIL(&window_pane_reflows, wp, rentry);
+		wp->flags |= PANE_REFLOWQUEUED;
+	}
+	if (!event_initialized(&window_pane_reflow_timer)) {
+		evtimer_set(&window_pane_reflow_timer,
+		    window_pane_reflow_callback, NULL);
+	}
+	if (!evtimer_pending(&window_pane_reflow_timer, NULL))
+		evtimer_add(&window_pane_reflow_timer, &tv);
+}
+
+/* Remove a pane from the reflow queue. */
+static void
+window_pane_reflow_cancel(struct window_pane *wp)
+{
+	if (wp->flags & PANE_REFLOWQUEUED) {
+		TAILQ_REMOVE(&window_pane_reflows, wp, rentry);
+		wp->flags &= ~PANE_REFLOWQUEUED;
+	}
+}
+
+/* Get the number of lines of history waiting to be reflowed. */
+u_int
+window_pane_reflow_pending(void)
+{
+	struct window_pane	*wp;
+	u_int			 n = 0;
+
+	TAILQ_FOREACH(wp, &window_pane_reflows, rentry)
+		n += wp->base.grid->reflow_lines;
+	return (n);
+}
+
 int
 window_pane_is_visible(struct window_pane *wp)
 {